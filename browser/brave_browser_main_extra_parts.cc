@@ -76,3 +76,10 @@ void BraveBrowserMainExtraParts::PreMainMessageLoopRun() {
   brave::BraveUptimeTracker::CreateInstance(g_browser_process->local_state());
 #endif  // !defined(OS_ANDROID)
 }
+
+void BraveBrowserMainExtraParts::PostMainMessageLoopRun() {
+#if !defined(OS_ANDROID)
+  // Runs before local state is committed for the last time.
+  brave::BraveUptimeTracker::DestroyInstance();
+#endif  // !defined(OS_ANDROID)
+}
@@ -171,7 +171,8 @@ void BindCosmeticFiltersResources(
 
   mojo::MakeSelfOwnedReceiver(
       std::make_unique<cosmetic_filters::CosmeticFiltersResources>(
-          settings_map, g_brave_browser_process->ad_block_service()),
+          settings_map, g_brave_browser_process->ad_block_service(),
+          profile->IsOffTheRecord()),
       std::move(receiver));
 }
 
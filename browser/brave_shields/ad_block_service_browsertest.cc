@@ -1066,6 +1066,61 @@ IN_PROC_BROWSER_TEST_F(AdBlockServiceTest, CosmeticFilteringGenerichide) {
                    "'display', 'inline')"));
 }
 
+// Test cosmetic resources cached for a URL aren't reused after the filter
+// lists are updated
+IN_PROC_BROWSER_TEST_F(AdBlockServiceTest,
+                       CosmeticFilteringCacheInvalidatedOnListUpdate) {
+  UpdateAdBlockInstanceWithRules("b.com###ad-banner");
+
+  WaitForBraveExtensionShieldsDataReady();
+
+  GURL tab_url =
+      embedded_test_server()->GetURL("b.com", "/cosmetic_filtering.html");
+  ui_test_utils::NavigateToURL(browser(), tab_url);
+
+  content::WebContents* contents =
+      browser()->tab_strip_model()->GetActiveWebContents();
+
+  ASSERT_EQ(true, EvalJs(contents,
+                         "checkSelector('#ad-banner', 'display', 'none')"));
+  ASSERT_EQ(true, EvalJs(contents,
+                         "checkSelector('.ad-banner', 'display', 'block')"));
+
+  UpdateAdBlockInstanceWithRules("b.com##.ad-banner");
+  ui_test_utils::NavigateToURL(browser(), tab_url);
+
+  ASSERT_EQ(true, EvalJs(contents,
+                         "checkSelector('#ad-banner', 'display', 'block')"));
+  ASSERT_EQ(true, EvalJs(contents,
+                         "checkSelector('.ad-banner', 'display', 'none')"));
+}
+
+// Test cosmetic resources cached for a URL aren't reused for other URLs of
+// the same host, which may be matched by different exceptions
+IN_PROC_BROWSER_TEST_F(AdBlockServiceTest, CosmeticFilteringCacheKeyedByUrl) {
+  UpdateAdBlockInstanceWithRules(
+      "##.ad\n"
+      "@@||b.com^*?generichide$generichide");
+
+  WaitForBraveExtensionShieldsDataReady();
+
+  GURL tab_url =
+      embedded_test_server()->GetURL("b.com", "/cosmetic_filtering.html");
+  ui_test_utils::NavigateToURL(browser(), tab_url);
+
+  content::WebContents* contents =
+      browser()->tab_strip_model()->GetActiveWebContents();
+
+  ASSERT_EQ(true, EvalJs(contents, "checkSelector('.ad', 'display', 'none')"));
+
+  GURL exception_url = embedded_test_server()->GetURL(
+      "b.com", "/cosmetic_filtering.html?generichide");
+  ui_test_utils::NavigateToURL(browser(), exception_url);
+
+  ASSERT_EQ(true,
+            EvalJs(contents, "checkSelector('.ad', 'display', 'block')"));
+}
+
 // Test custom style rules
 IN_PROC_BROWSER_TEST_F(AdBlockServiceTest, CosmeticFilteringCustomStyle) {
   UpdateAdBlockInstanceWithRules("b.com##.ad:style(padding-bottom: 10px)");
@@ -7,10 +7,13 @@
 
 #include "base/strings/utf_string_conversions.h"
 #include "base/test/bind.h"
+#include "base/test/metrics/histogram_tester.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
+#include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/common/features.h"
+#include "chrome/browser/content_settings/host_content_settings_map_factory.h"
 #include "chrome/browser/extensions/extension_browsertest.h"
 #include "chrome/browser/interstitials/security_interstitial_page_test_utils.h"
 #include "chrome/browser/ui/browser.h"
@@ -383,6 +386,93 @@ IN_PROC_BROWSER_TEST_F(DomainBlockTest, NoInterstitialUnlessAggressive) {
   ASSERT_FALSE(IsShowingInterstitial());
 }
 
+IN_PROC_BROWSER_TEST_F(DomainBlockTest, AllowedNavigationNotDeferredUnderLoad) {
+  ASSERT_TRUE(InstallDefaultAdBlockExtension());
+  UpdateAdBlockInstanceWithRules("*ad_banner.png");
+  GURL url = embedded_test_server()->GetURL("a.com", "/simple.html");
+  SetCosmeticFilteringControlType(content_settings(), ControlType::BLOCK, url);
+  base::HistogramTester histogram_tester;
+
+  // Navigate to a page on a.com. This should wait for the ad block service.
+  NavigateTo(url);
+  ASSERT_FALSE(IsShowingInterstitial());
+  histogram_tester.ExpectTotalCount("Brave.DomainBlock.NavigationDelay", 1);
+
+  // Keep the ad block task runner busy, as a page loading many subresources
+  // does.
+  brave_shields::AdBlockService* ad_block_service =
+      g_brave_browser_process->ad_block_service();
+  for (int i = 0; i < 1000; i++) {
+    ad_block_service->GetTaskRunner()->PostTask(
+        FROM_HERE,
+        base::BindOnce(
+            [](brave_shields::AdBlockService* ad_block_service, int i) {
+              bool did_match_rule = false;
+              bool did_match_exception = false;
+              bool did_match_important = false;
+              std::string mock_data_url;
+              ad_block_service->ShouldStartRequest(
+                  GURL("https://b.com/" + std::to_string(i) +
+                       "/ad_banner.png"),
+                  blink::mojom::ResourceType::kImage, "a.com",
+                  &did_match_rule, &did_match_exception, &did_match_important,
+                  &mock_data_url);
+            },
+            ad_block_service, i));
+  }
+
+  // Navigate to the same page again. The allowed verdict is still valid, so
+  // the navigation should start without waiting for the ad block service.
+  NavigateTo(url);
+  ASSERT_FALSE(IsShowingInterstitial());
+  histogram_tester.ExpectTotalCount("Brave.DomainBlock.NavigationDelay", 1);
+
+  // Block a.com. The next navigation should wait for the ad block service
+  // again and be interrupted by the domain block interstitial.
+  BlockDomainByURL(url);
+  NavigateTo(url);
+  ASSERT_TRUE(IsShowingInterstitial());
+  histogram_tester.ExpectTotalCount("Brave.DomainBlock.NavigationDelay", 2);
+}
+
+IN_PROC_BROWSER_TEST_F(DomainBlockTest,
+                       AllowedVerdictInvalidatedByCustomFilters) {
+  ASSERT_TRUE(InstallDefaultAdBlockExtension());
+  GURL url = embedded_test_server()->GetURL("a.com", "/simple.html");
+  SetCosmeticFilteringControlType(content_settings(), ControlType::BLOCK, url);
+
+  // Navigate to a page on a.com, which remembers that it is allowed.
+  NavigateTo(url);
+  ASSERT_FALSE(IsShowingInterstitial());
+
+  // Block a.com with a custom filter, then navigate to the same page again.
+  // The remembered verdict no longer applies, so this should be interrupted
+  // by the domain block interstitial.
+  ASSERT_TRUE(g_brave_browser_process->ad_block_custom_filters_service()
+                  ->UpdateCustomFilters("||a.com^"));
+  NavigateTo(url);
+  ASSERT_TRUE(IsShowingInterstitial());
+}
+
+IN_PROC_BROWSER_TEST_F(DomainBlockTest, OffTheRecordVerdictsNotRemembered) {
+  ASSERT_TRUE(InstallDefaultAdBlockExtension());
+  UpdateAdBlockInstanceWithRules("*ad_banner.png");
+  Browser* incognito_browser = CreateIncognitoBrowser();
+  GURL url = embedded_test_server()->GetURL("a.com", "/simple.html");
+  SetCosmeticFilteringControlType(
+      HostContentSettingsMapFactory::GetForProfile(
+          incognito_browser->profile()),
+      ControlType::BLOCK, url);
+  base::HistogramTester histogram_tester;
+
+  // Every navigation in a private window waits for the ad block service,
+  // since its URLs are kept out of the cache shared with regular profiles.
+  ui_test_utils::NavigateToURL(incognito_browser, url);
+  histogram_tester.ExpectTotalCount("Brave.DomainBlock.NavigationDelay", 1);
+  ui_test_utils::NavigateToURL(incognito_browser, url);
+  histogram_tester.ExpectTotalCount("Brave.DomainBlock.NavigationDelay", 2);
+}
+
 IN_PROC_BROWSER_TEST_F(DomainBlockDisabledTest, NoInterstitial) {
   ASSERT_TRUE(InstallDefaultAdBlockExtension());
   GURL url = embedded_test_server()->GetURL("a.com", "/simple.html");
@@ -60,6 +60,7 @@
 #endif
 
 #if BUILDFLAG(ENABLE_TOR)
+#include "brave/browser/tor/tor_profile_service_factory.h"
 #include "brave/components/tor/onion_location_tab_helper.h"
 #include "brave/components/tor/tor_tab_helper.h"
 #endif
@@ -118,7 +119,10 @@ void AttachTabHelpers(content::WebContents* web_contents) {
 
 #if BUILDFLAG(ENABLE_TOR)
   tor::TorTabHelper::MaybeCreateForWebContents(
-      web_contents, web_contents->GetBrowserContext()->IsTor());
+      web_contents, web_contents->GetBrowserContext()->IsTor()
+                        ? TorProfileServiceFactory::GetForContext(
+                              web_contents->GetBrowserContext())
+                        : nullptr);
   tor::OnionLocationTabHelper::CreateForWebContents(web_contents);
 #endif
 
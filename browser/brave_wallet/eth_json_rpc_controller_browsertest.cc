@@ -3,8 +3,15 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this file,
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include <atomic>
+
+#include "base/barrier_closure.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
 #include "base/path_service.h"
 #include "base/scoped_observer.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
 #include "brave/browser/brave_wallet/brave_wallet_service_factory.h"
 #include "brave/common/brave_paths.h"
 #include "brave/common/pref_names.h"
@@ -62,6 +69,72 @@ std::unique_ptr<net::test_server::HttpResponse> HandleRequest(
   return std::move(http_response);
 }
 
+constexpr char kERC20Balance[] =
+    "0x00000000000000000000000000000000000000000000000166e12cfce39a0000";
+constexpr char kBalance[] = "0xb539d5";
+
+base::Value GetStandInResult(const base::Value& call) {
+  base::Value response(base::Value::Type::DICTIONARY);
+  response.SetStringKey("jsonrpc", "2.0");
+  const base::Value* id = call.FindKey("id");
+  if (id)
+    response.SetKey("id", id->Clone());
+  const std::string* method = call.FindStringKey("method");
+  response.SetStringKey("result", method && *method == "eth_call"
+                                      ? kERC20Balance
+                                      : kBalance);
+  return response;
+}
+
+// Local JSON-RPC stand-in which understands batches and counts the HTTP
+// requests it receives.
+std::unique_ptr<net::test_server::HttpResponse> HandleBatchRequest(
+    std::atomic<int>* request_count,
+    const net::test_server::HttpRequest& request) {
+  ++(*request_count);
+  std::unique_ptr<net::test_server::BasicHttpResponse> http_response(
+      new net::test_server::BasicHttpResponse());
+  http_response->set_code(net::HTTP_OK);
+  http_response->set_content_type("application/json");
+
+  base::Optional<base::Value> calls = base::JSONReader::Read(request.content);
+  if (!calls) {
+    http_response->set_code(net::HTTP_BAD_REQUEST);
+    return std::move(http_response);
+  }
+  base::Value result;
+  if (calls->is_list()) {
+    result = base::Value(base::Value::Type::LIST);
+    // Answer in reverse order, which is allowed by the JSON-RPC spec.
+    const auto list = calls->GetList();
+    for (auto it = list.rbegin(); it != list.rend(); ++it)
+      result.Append(GetStandInResult(*it));
+  } else {
+    result = GetStandInResult(*calls);
+  }
+  std::string content;
+  base::JSONWriter::Write(result, &content);
+  http_response->set_content(content);
+  return std::move(http_response);
+}
+
+// Answers every call with a JSON-RPC error, which still has a 200 status.
+std::unique_ptr<net::test_server::HttpResponse> HandleRequestRpcError(
+    std::atomic<int>* request_count,
+    const net::test_server::HttpRequest& request) {
+  ++(*request_count);
+  std::unique_ptr<net::test_server::BasicHttpResponse> http_response(
+      new net::test_server::BasicHttpResponse());
+  http_response->set_code(net::HTTP_OK);
+  http_response->set_content_type("application/json");
+  http_response->set_content(R"({
+    "jsonrpc": "2.0",
+    "id": 1,
+    "error": {"code": -32005, "message": "limit exceeded"}
+  })");
+  return std::move(http_response);
+}
+
 std::unique_ptr<net::test_server::HttpResponse> HandleRequestServerError(
     const net::test_server::HttpRequest& request) {
   std::unique_ptr<net::test_server::BasicHttpResponse> http_response(
@@ -71,6 +144,18 @@ std::unique_ptr<net::test_server::HttpResponse> HandleRequestServerError(
   return std::move(http_response);
 }
 
+std::unique_ptr<net::test_server::HttpResponse> HandleBatchServerError(
+    std::atomic<int>* request_count,
+    const net::test_server::HttpRequest& request) {
+  ++(*request_count);
+  std::unique_ptr<net::test_server::BasicHttpResponse> http_response(
+      new net::test_server::BasicHttpResponse());
+  http_response->set_content_type("text/html");
+  http_response->set_code(net::HTTP_INTERNAL_SERVER_ERROR);
+  http_response->set_content("batch failed");
+  return std::move(http_response);
+}
+
 }  // namespace
 
 class EthJsonRpcBrowserTest : public InProcessBrowserTest {
@@ -283,3 +368,175 @@ IN_PROC_BROWSER_TEST_F(EthJsonRpcBrowserTest,
 
   WaitForResponse("", false);
 }
+
+IN_PROC_BROWSER_TEST_F(EthJsonRpcBrowserTest,
+                       ReadOnlyRequestsBatchedCoalescedAndCached) {
+  std::atomic<int> request_count(0);
+  ResetHTTPSServer(base::BindRepeating(&HandleBatchRequest, &request_count));
+  auto* controller = GetEthJsonRpcController();
+
+  // A portfolio view: one balance per token plus duplicated ETH balance
+  // queries.
+  const int kTokensCount = 50;
+  const int kDuplicatedCallsCount = 3;
+  base::ElapsedTimer timer;
+  base::RunLoop run_loop;
+  base::RepeatingClosure barrier = base::BarrierClosure(
+      kTokensCount + kDuplicatedCallsCount, run_loop.QuitClosure());
+  for (int i = 0; i < kTokensCount; ++i) {
+    EXPECT_TRUE(controller->GetERC20TokenBalance(
+        "0x0d8775f648430679a709e98d2b0cb6250d2887ef",
+        base::StringPrintf("0x%040x", i + 1),
+        base::BindOnce(
+            [](base::RepeatingClosure barrier, bool success,
+               const std::string& balance) {
+              EXPECT_TRUE(success);
+              EXPECT_EQ(balance, kERC20Balance);
+              barrier.Run();
+            },
+            barrier)));
+  }
+  auto on_get_balance = base::BindRepeating(
+      [](base::RepeatingClosure barrier, bool success,
+         const std::string& balance) {
+        EXPECT_TRUE(success);
+        EXPECT_EQ(balance, kBalance);
+        barrier.Run();
+      },
+      barrier);
+  for (int i = 0; i < kDuplicatedCallsCount; ++i)
+    controller->GetBalance("0x4e02f254184E904300e0775E4b8eeCB1",
+                           on_get_balance);
+  run_loop.Run();
+  VLOG(1) << "End-to-end latency for " << kTokensCount + kDuplicatedCallsCount
+          << " calls: " << timer.Elapsed().InMilliseconds() << "ms";
+  EXPECT_EQ(request_count, 1);
+
+  // Served from the cache.
+  base::RunLoop cached_run_loop;
+  controller->GetBalance(
+      "0x4e02f254184E904300e0775E4b8eeCB1",
+      base::BindOnce(
+          [](base::OnceClosure quit, bool success, const std::string& balance) {
+            EXPECT_TRUE(success);
+            EXPECT_EQ(balance, kBalance);
+            std::move(quit).Run();
+          },
+          cached_run_loop.QuitClosure()));
+  cached_run_loop.Run();
+  EXPECT_EQ(request_count, 1);
+
+  // Switching network drops cached responses.
+  std::atomic<int> new_request_count(0);
+  ResetHTTPSServer(
+      base::BindRepeating(&HandleBatchRequest, &new_request_count));
+  base::RunLoop new_network_run_loop;
+  controller->GetBalance(
+      "0x4e02f254184E904300e0775E4b8eeCB1",
+      base::BindOnce(
+          [](base::OnceClosure quit, bool success, const std::string& balance) {
+            EXPECT_TRUE(success);
+            EXPECT_EQ(balance, kBalance);
+            std::move(quit).Run();
+          },
+          new_network_run_loop.QuitClosure()));
+  new_network_run_loop.Run();
+  EXPECT_EQ(new_request_count, 1);
+  EXPECT_EQ(request_count, 1);
+}
+
+IN_PROC_BROWSER_TEST_F(EthJsonRpcBrowserTest, ReadOnlyErrorsAreNotCached) {
+  std::atomic<int> request_count(0);
+  ResetHTTPSServer(
+      base::BindRepeating(&HandleRequestRpcError, &request_count));
+  auto* controller = GetEthJsonRpcController();
+
+  for (int i = 1; i <= 2; ++i) {
+    base::RunLoop run_loop;
+    controller->GetBalance(
+        "0x4e02f254184E904300e0775E4b8eeCB1",
+        base::BindOnce(
+            [](base::OnceClosure quit, bool success,
+               const std::string& balance) {
+              EXPECT_FALSE(success);
+              std::move(quit).Run();
+            },
+            run_loop.QuitClosure()));
+    run_loop.Run();
+    EXPECT_EQ(request_count, i);
+  }
+}
+
+IN_PROC_BROWSER_TEST_F(EthJsonRpcBrowserTest,
+                       ReadOnlyBatchFailurePassedToCallers) {
+  std::atomic<int> request_count(0);
+  ResetHTTPSServer(
+      base::BindRepeating(&HandleBatchServerError, &request_count));
+  auto* controller = GetEthJsonRpcController();
+
+  const int kCallsCount = 3;
+  base::RunLoop run_loop;
+  base::RepeatingClosure barrier =
+      base::BarrierClosure(kCallsCount, run_loop.QuitClosure());
+  for (int i = 0; i < kCallsCount; ++i) {
+    controller->RequestReadOnly(
+        base::StringPrintf(R"({"id":1,"jsonrpc":"2.0",)"
+                           R"("method":"eth_getBalance",)"
+                           R"("params":["0x%040x","latest"]})",
+                           i + 1),
+        base::BindOnce(
+            [](base::RepeatingClosure barrier, const int status,
+               const std::string& body,
+               const std::map<std::string, std::string>& headers) {
+              EXPECT_EQ(status, net::HTTP_INTERNAL_SERVER_ERROR);
+              EXPECT_EQ(body, "batch failed");
+              barrier.Run();
+            },
+            barrier));
+  }
+  run_loop.Run();
+  EXPECT_EQ(request_count, 1);
+}
+
+IN_PROC_BROWSER_TEST_F(EthJsonRpcBrowserTest,
+                       TransactionSubmissionDropsCachedResponses) {
+  std::atomic<int> request_count(0);
+  ResetHTTPSServer(base::BindRepeating(&HandleBatchRequest, &request_count));
+  auto* controller = GetEthJsonRpcController();
+
+  auto get_balance = [&]() {
+    base::RunLoop run_loop;
+    controller->GetBalance(
+        "0x4e02f254184E904300e0775E4b8eeCB1",
+        base::BindOnce(
+            [](base::OnceClosure quit, bool success,
+               const std::string& balance) {
+              EXPECT_TRUE(success);
+              std::move(quit).Run();
+            },
+            run_loop.QuitClosure()));
+    run_loop.Run();
+  };
+
+  get_balance();
+  get_balance();
+  EXPECT_EQ(request_count, 1);
+
+  base::RunLoop send_run_loop;
+  controller->Request(
+      R"({"id":1,"jsonrpc":"2.0","method":"eth_sendRawTransaction",)"
+      R"("params":["0xf86b"]})",
+      base::BindOnce(
+          [](base::OnceClosure quit, const int status, const std::string& body,
+             const std::map<std::string, std::string>& headers) {
+            std::move(quit).Run();
+          },
+          send_run_loop.QuitClosure()),
+      true);
+  send_run_loop.Run();
+  EXPECT_EQ(request_count, 2);
+
+  // The balance is fetched again after the transaction.
+  get_balance();
+  EXPECT_EQ(request_count, 3);
+}
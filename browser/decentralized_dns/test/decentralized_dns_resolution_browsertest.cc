@@ -0,0 +1,189 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/barrier_closure.h"
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/scoped_feature_list.h"
+#include "brave/browser/brave_wallet/brave_wallet_service_factory.h"
+#include "brave/browser/decentralized_dns/decentralized_dns_service_factory.h"
+#include "brave/browser/net/decentralized_dns_network_delegate_helper.h"
+#include "brave/browser/net/url_context.h"
+#include "brave/components/brave_wallet/browser/brave_wallet_service.h"
+#include "brave/components/brave_wallet/browser/eth_json_rpc_controller.h"
+#include "brave/components/decentralized_dns/constants.h"
+#include "brave/components/decentralized_dns/decentralized_dns_service.h"
+#include "brave/components/decentralized_dns/features.h"
+#include "brave/components/decentralized_dns/pref_names.h"
+#include "chrome/browser/browser_process.h"
+#include "chrome/browser/profiles/profile.h"
+#include "chrome/browser/ui/browser.h"
+#include "chrome/test/base/in_process_browser_test.h"
+#include "components/prefs/pref_service.h"
+#include "content/public/test/browser_test.h"
+#include "net/base/net_errors.h"
+#include "net/dns/mock_host_resolver.h"
+#include "net/test/embedded_test_server/http_request.h"
+#include "net/test/embedded_test_server/http_response.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace {
+
+// getMany result with dweb.ipfs.hash set to
+// QmWrdNJWMbvRxxzLhojVKaBDswS4KNVM7LvjsN7QbDrvka.
+constexpr char kGetManyResult[] =
+    "0x0000000000000000000000000000000000000000000000000000000000000020"
+    "0000000000000000000000000000000000000000000000000000000000000006"
+    "00000000000000000000000000000000000000000000000000000000000000c0"
+    "0000000000000000000000000000000000000000000000000000000000000120"
+    "0000000000000000000000000000000000000000000000000000000000000140"
+    "0000000000000000000000000000000000000000000000000000000000000160"
+    "0000000000000000000000000000000000000000000000000000000000000180"
+    "00000000000000000000000000000000000000000000000000000000000001a0"
+    "000000000000000000000000000000000000000000000000000000000000002e"
+    "516d5772644e4a574d62765278787a4c686f6a564b614244737753344b4e564d"
+    "374c766a734e3751624472766b61000000000000000000000000000000000000"
+    "0000000000000000000000000000000000000000000000000000000000000000"
+    "0000000000000000000000000000000000000000000000000000000000000000"
+    "0000000000000000000000000000000000000000000000000000000000000000"
+    "0000000000000000000000000000000000000000000000000000000000000000"
+    "0000000000000000000000000000000000000000000000000000000000000000";
+
+// Local JSON-RPC stand-in counting the resolver calls it receives.
+std::unique_ptr<net::test_server::HttpResponse> HandleRequest(
+    std::atomic<int>* request_count,
+    const net::test_server::HttpRequest& request) {
+  ++(*request_count);
+  auto http_response = std::make_unique<net::test_server::BasicHttpResponse>();
+  http_response->set_code(net::HTTP_OK);
+  http_response->set_content_type("application/json");
+  http_response->set_content(base::StringPrintf(
+      R"({"jsonrpc":"2.0","id":1,"result":"%s"})", kGetManyResult));
+  return std::move(http_response);
+}
+
+}  // namespace
+
+namespace decentralized_dns {
+
+class DecentralizedDnsResolutionBrowserTest : public InProcessBrowserTest {
+ public:
+  DecentralizedDnsResolutionBrowserTest() {
+    feature_list_.InitAndEnableFeature(features::kDecentralizedDns);
+  }
+  ~DecentralizedDnsResolutionBrowserTest() override = default;
+
+  void SetUpOnMainThread() override {
+    InProcessBrowserTest::SetUpOnMainThread();
+    host_resolver()->AddRule("*", "127.0.0.1");
+
+    https_server_ = std::make_unique<net::EmbeddedTestServer>(
+        net::test_server::EmbeddedTestServer::TYPE_HTTPS);
+    https_server_->SetSSLConfig(net::EmbeddedTestServer::CERT_OK);
+    https_server_->RegisterRequestHandler(
+        base::BindRepeating(&HandleRequest, &request_count_));
+    ASSERT_TRUE(https_server_->Start());
+
+    auto* wallet_service =
+        BraveWalletServiceFactory::GetInstance()->GetForContext(
+            browser()->profile());
+    ASSERT_TRUE(wallet_service);
+    wallet_service->controller()->SetCustomNetwork(https_server_->base_url());
+  }
+
+  PrefService* local_state() { return g_browser_process->local_state(); }
+
+ protected:
+  std::atomic<int> request_count_{0};
+
+ private:
+  base::test::ScopedFeatureList feature_list_;
+  std::unique_ptr<net::EmbeddedTestServer> https_server_;
+};
+
+IN_PROC_BROWSER_TEST_F(DecentralizedDnsResolutionBrowserTest,
+                       SubresourcesShareOneResolution) {
+  local_state()->SetInteger(kUnstoppableDomainsResolveMethod,
+                            static_cast<int>(ResolveMethodTypes::ETHEREUM));
+
+  // A page on a .crypto host with 30 subresources.
+  const int kSubresourcesCount = 30;
+  std::vector<std::shared_ptr<brave::BraveRequestInfo>> requests;
+  base::RunLoop run_loop;
+  base::RepeatingClosure barrier =
+      base::BarrierClosure(kSubresourcesCount + 1, run_loop.QuitClosure());
+  for (int i = 0; i <= kSubresourcesCount; ++i) {
+    auto ctx = std::make_shared<brave::BraveRequestInfo>(
+        GURL(base::StringPrintf("http://brave.crypto/resource_%d.js", i)));
+    ctx->browser_context = browser()->profile();
+    EXPECT_EQ(OnBeforeURLRequest_DecentralizedDnsPreRedirectWork(barrier, ctx),
+              net::ERR_IO_PENDING);
+    requests.push_back(ctx);
+  }
+  run_loop.Run();
+
+  EXPECT_EQ(request_count_, 1);
+  for (const auto& ctx : requests) {
+    EXPECT_EQ(ctx->new_url_spec,
+              "ipfs://QmWrdNJWMbvRxxzLhojVKaBDswS4KNVM7LvjsN7QbDrvka");
+  }
+
+  // Next navigation to the host is served from the cache.
+  base::RunLoop cached_run_loop;
+  auto ctx = std::make_shared<brave::BraveRequestInfo>(
+      GURL("http://brave.crypto/"));
+  ctx->browser_context = browser()->profile();
+  EXPECT_EQ(OnBeforeURLRequest_DecentralizedDnsPreRedirectWork(
+                cached_run_loop.QuitClosure(), ctx),
+            net::ERR_IO_PENDING);
+  cached_run_loop.Run();
+  EXPECT_EQ(request_count_, 1);
+  EXPECT_EQ(ctx->new_url_spec,
+            "ipfs://QmWrdNJWMbvRxxzLhojVKaBDswS4KNVM7LvjsN7QbDrvka");
+
+  // Changing the resolver preference drops cached results.
+  local_state()->SetInteger(kUnstoppableDomainsResolveMethod,
+                            static_cast<int>(ResolveMethodTypes::ASK));
+  local_state()->SetInteger(kUnstoppableDomainsResolveMethod,
+                            static_cast<int>(ResolveMethodTypes::ETHEREUM));
+  base::RunLoop uncached_run_loop;
+  ctx = std::make_shared<brave::BraveRequestInfo>(GURL("http://brave.crypto/"));
+  ctx->browser_context = browser()->profile();
+  EXPECT_EQ(OnBeforeURLRequest_DecentralizedDnsPreRedirectWork(
+                uncached_run_loop.QuitClosure(), ctx),
+            net::ERR_IO_PENDING);
+  uncached_run_loop.Run();
+  EXPECT_EQ(request_count_, 2);
+}
+
+IN_PROC_BROWSER_TEST_F(DecentralizedDnsResolutionBrowserTest,
+                       PrivateWindowIsNotResolved) {
+  local_state()->SetInteger(kUnstoppableDomainsResolveMethod,
+                            static_cast<int>(ResolveMethodTypes::ETHEREUM));
+  Profile* private_profile = CreateIncognitoBrowser()->profile();
+
+  // Requests in private windows are left alone, as before resolutions were
+  // cached.
+  auto ctx = std::make_shared<brave::BraveRequestInfo>(
+      GURL("http://brave.crypto/"));
+  ctx->browser_context = private_profile;
+  EXPECT_EQ(OnBeforeURLRequest_DecentralizedDnsPreRedirectWork(
+                base::DoNothing(), ctx),
+            net::OK);
+  EXPECT_TRUE(ctx->new_url_spec.empty());
+  EXPECT_EQ(request_count_, 0);
+
+  // No service is created for the private profile.
+  EXPECT_FALSE(DecentralizedDnsServiceFactory::GetForContext(private_profile));
+}
+
+}  // namespace decentralized_dns
@@ -0,0 +1,167 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/decentralized_dns/resolution_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/test/task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace decentralized_dns {
+
+class ResolutionCacheUnitTest : public testing::Test {
+ public:
+  ResolutionCacheUnitTest() = default;
+  ~ResolutionCacheUnitTest() override = default;
+
+  // Returns a starter which records its callback into |pending_| instead of
+  // issuing a request.
+  ResolutionCache::ResolveStarter GetStarter(bool started = true) {
+    return base::BindOnce(
+        [](ResolutionCacheUnitTest* test, bool started,
+           ResolutionCache::ResolveCallback callback) {
+          ++test->starts_count_;
+          if (started)
+            test->pending_.push_back(std::move(callback));
+          return started;
+        },
+        base::Unretained(this), started);
+  }
+
+  ResolutionCache::ResolveCallback GetCallback() {
+    return base::BindOnce(
+        [](ResolutionCacheUnitTest* test, bool success,
+           const std::string& result) {
+          ++test->callbacks_count_;
+          test->last_success_ = success;
+          test->last_result_ = result;
+        },
+        base::Unretained(this));
+  }
+
+  void FinishPending(bool success, const std::string& result) {
+    std::vector<ResolutionCache::ResolveCallback> pending;
+    pending.swap(pending_);
+    for (auto& callback : pending)
+      std::move(callback).Run(success, result);
+  }
+
+ protected:
+  base::test::TaskEnvironment task_environment_{
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME};
+  std::vector<ResolutionCache::ResolveCallback> pending_;
+  int starts_count_ = 0;
+  int callbacks_count_ = 0;
+  bool last_success_ = false;
+  std::string last_result_;
+};
+
+TEST_F(ResolutionCacheUnitTest, CoalescesAndCaches) {
+  ResolutionCache cache;
+
+  // A page with 30 subresources on the same host.
+  for (int i = 0; i < 30; ++i)
+    cache.Resolve("brave.crypto", GetStarter(), GetCallback());
+  EXPECT_EQ(starts_count_, 1);
+  EXPECT_EQ(callbacks_count_, 0);
+
+  FinishPending(true, "0x1234");
+  EXPECT_EQ(callbacks_count_, 30);
+  EXPECT_TRUE(last_success_);
+  EXPECT_EQ(last_result_, "0x1234");
+
+  // Served from the cache, asynchronously.
+  cache.Resolve("brave.crypto", GetStarter(), GetCallback());
+  EXPECT_EQ(callbacks_count_, 30);
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(callbacks_count_, 31);
+  EXPECT_EQ(last_result_, "0x1234");
+  EXPECT_EQ(starts_count_, 1);
+
+  // Other hosts are resolved separately.
+  cache.Resolve("test.crypto", GetStarter(), GetCallback());
+  EXPECT_EQ(starts_count_, 2);
+  FinishPending(true, "0x5678");
+  EXPECT_EQ(last_result_, "0x5678");
+
+  // Expired entries are resolved again.
+  task_environment_.FastForwardBy(base::TimeDelta::FromMinutes(31));
+  cache.Resolve("brave.crypto", GetStarter(), GetCallback());
+  EXPECT_EQ(starts_count_, 3);
+  FinishPending(true, "0x9abc");
+  EXPECT_EQ(last_result_, "0x9abc");
+}
+
+TEST_F(ResolutionCacheUnitTest, NegativeCaching) {
+  ResolutionCache cache;
+
+  cache.Resolve("brave.crypto", GetStarter(), GetCallback());
+  FinishPending(false, "");
+  EXPECT_EQ(callbacks_count_, 1);
+  EXPECT_FALSE(last_success_);
+
+  cache.Resolve("brave.crypto", GetStarter(), GetCallback());
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(starts_count_, 1);
+  EXPECT_EQ(callbacks_count_, 2);
+  EXPECT_FALSE(last_success_);
+
+  // Failures are kept for a shorter time.
+  task_environment_.FastForwardBy(base::TimeDelta::FromMinutes(2));
+  cache.Resolve("brave.crypto", GetStarter(), GetCallback());
+  EXPECT_EQ(starts_count_, 2);
+  FinishPending(true, "0x1234");
+  EXPECT_TRUE(last_success_);
+
+  // Resolutions which can't be started fail, but not before Resolve()
+  // returns.
+  cache.Resolve("test.crypto", GetStarter(false), GetCallback());
+  EXPECT_EQ(starts_count_, 3);
+  EXPECT_EQ(callbacks_count_, 3);
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(callbacks_count_, 4);
+  EXPECT_FALSE(last_success_);
+}
+
+TEST_F(ResolutionCacheUnitTest, Clear) {
+  ResolutionCache cache;
+
+  cache.Resolve("brave.crypto", GetStarter(), GetCallback());
+  FinishPending(true, "0x1234");
+  EXPECT_EQ(cache.size(), 1u);
+
+  cache.Clear();
+  EXPECT_EQ(cache.size(), 0u);
+  cache.Resolve("brave.crypto", GetStarter(), GetCallback());
+  EXPECT_EQ(starts_count_, 2);
+
+  // Callbacks waiting when clearing fail, and later requests don't join the
+  // resolution started before.
+  cache.Clear();
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(callbacks_count_, 2);
+  EXPECT_FALSE(last_success_);
+  cache.Resolve("brave.crypto", GetStarter(), GetCallback());
+  EXPECT_EQ(starts_count_, 3);
+
+  // Results of resolutions started before clearing are ignored.
+  std::vector<ResolutionCache::ResolveCallback> pending;
+  pending.swap(pending_);
+  std::move(pending.front()).Run(true, "0x5678");
+  EXPECT_EQ(callbacks_count_, 2);
+  EXPECT_EQ(cache.size(), 0u);
+
+  std::move(pending.back()).Run(true, "0x9abc");
+  EXPECT_EQ(callbacks_count_, 3);
+  EXPECT_EQ(last_result_, "0x9abc");
+  EXPECT_EQ(cache.size(), 1u);
+}
+
+}  // namespace decentralized_dns
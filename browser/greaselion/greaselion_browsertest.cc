@@ -4,9 +4,11 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "base/containers/flat_map.h"
+#include "base/files/file_util.h"
 #include "base/path_service.h"
 #include "base/run_loop.h"
 #include "base/task/post_task.h"
+#include "base/threading/thread_restrictions.h"
 #include "base/test/thread_test_helper.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/browser/brave_rewards/rewards_service_factory.h"
@@ -23,6 +25,7 @@
 #include "chrome/test/base/ui_test_utils.h"
 #include "content/public/test/browser_test.h"
 #include "content/public/test/browser_test_utils.h"
+#include "extensions/browser/extension_registry.h"
 #include "net/dns/mock_host_resolver.h"
 #include "ui/base/ui_base_switches.h"
 
@@ -354,6 +357,95 @@ IN_PROC_BROWSER_TEST_F(GreaselionServiceTest, IsGreaselionExtension) {
   EXPECT_TRUE(greaselion_service->IsGreaselionExtension(extension_ids[0]));
 }
 
+// Ensure a state change only installs the rules whose match result changed,
+// and that the other extensions are left alone.
+IN_PROC_BROWSER_TEST_F(GreaselionServiceTest, IncrementalUpdate) {
+  ASSERT_TRUE(InstallMockExtension());
+
+  GreaselionService* greaselion_service =
+      GreaselionServiceFactory::GetForBrowserContext(profile());
+  ASSERT_TRUE(greaselion_service);
+  extensions::ExtensionRegistry* registry =
+      extensions::ExtensionRegistry::Get(profile());
+
+  auto extension_ids = greaselion_service->GetExtensionIdsForTesting();
+  ASSERT_GT(extension_ids.size(), 0UL);
+  std::vector<const extensions::Extension*> extensions;
+  for (const auto& id : extension_ids) {
+    const extensions::Extension* extension =
+        registry->enabled_extensions().GetByID(id);
+    ASSERT_TRUE(extension);
+    // Converted extensions are kept in the on-disk cache.
+    EXPECT_EQ(extension->path().DirName().BaseName().AsUTF8Unsafe(), "Cache");
+    extensions.push_back(extension);
+  }
+
+  greaselion_service->SetFeatureEnabled(greaselion::AUTO_CONTRIBUTION, true);
+  GreaselionServiceWaiter(greaselion_service).Wait();
+  EXPECT_EQ(extension_ids.size() + 1,
+            greaselion_service->GetExtensionIdsForTesting().size());
+  for (const extensions::Extension* extension : extensions) {
+    EXPECT_EQ(extension,
+              registry->enabled_extensions().GetByID(extension->id()));
+  }
+
+  greaselion_service->SetFeatureEnabled(greaselion::AUTO_CONTRIBUTION, false);
+  GreaselionServiceWaiter(greaselion_service).Wait();
+  EXPECT_EQ(extension_ids.size(),
+            greaselion_service->GetExtensionIdsForTesting().size());
+  for (const extensions::Extension* extension : extensions) {
+    EXPECT_EQ(extension,
+              registry->enabled_extensions().GetByID(extension->id()));
+  }
+}
+
+// Ensure scripts edited in place, as happens in dev mode, are converted again
+// instead of being loaded from the cache.
+IN_PROC_BROWSER_TEST_F(GreaselionServiceTest, ScriptsEditedInPlace) {
+  ASSERT_TRUE(InstallMockExtension());
+
+  GreaselionService* greaselion_service =
+      GreaselionServiceFactory::GetForBrowserContext(profile());
+  ASSERT_TRUE(greaselion_service);
+  extensions::ExtensionRegistry* registry =
+      extensions::ExtensionRegistry::Get(profile());
+
+  auto extension_ids = greaselion_service->GetExtensionIdsForTesting();
+  ASSERT_GT(extension_ids.size(), 0UL);
+  base::flat_map<extensions::ExtensionId, base::FilePath> paths;
+  for (const auto& id : extension_ids) {
+    const extensions::Extension* extension =
+        registry->enabled_extensions().GetByID(id);
+    ASSERT_TRUE(extension);
+    paths[id] = extension->path();
+  }
+
+  {
+    base::ScopedAllowBlockingForTesting allow_blocking;
+    for (const auto& rule :
+         *g_brave_browser_process->greaselion_download_service()->rules()) {
+      for (const auto& script : rule->scripts()) {
+        std::string contents;
+        ASSERT_TRUE(base::ReadFileToString(script, &contents));
+        ASSERT_TRUE(base::WriteFile(script, contents + "\n// edited\n"));
+      }
+    }
+  }
+  greaselion_service->UpdateInstalledExtensions();
+  GreaselionServiceWaiter(greaselion_service).Wait();
+
+  // Extension ids don't depend on the script contents, only the cached
+  // copies they are loaded from do.
+  EXPECT_EQ(extension_ids.size(),
+            greaselion_service->GetExtensionIdsForTesting().size());
+  for (const auto& id_and_path : paths) {
+    const extensions::Extension* extension =
+        registry->enabled_extensions().GetByID(id_and_path.first);
+    ASSERT_TRUE(extension);
+    EXPECT_NE(id_and_path.second, extension->path());
+  }
+}
+
 IN_PROC_BROWSER_TEST_F(GreaselionServiceTest, IsNotGreaselionExtension) {
   ASSERT_TRUE(InstallMockExtension());
 
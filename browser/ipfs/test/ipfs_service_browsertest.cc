@@ -3,18 +3,28 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this file,
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include <set>
+
 #include "base/base64.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/path_service.h"
 #include "base/run_loop.h"
 #include "base/strings/strcat.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/synchronization/lock.h"
 #include "base/test/mock_callback.h"
 #include "base/test/scoped_feature_list.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/timer/elapsed_timer.h"
 #include "brave/browser/ipfs/ipfs_service_factory.h"
 #include "brave/common/brave_paths.h"
 #include "brave/components/ipfs/features.h"
 #include "brave/components/ipfs/import/imported_data.h"
 #include "brave/components/ipfs/ipfs_constants.h"
 #include "brave/components/ipfs/ipfs_service.h"
+#include "brave/components/ipfs/ipfs_service_observer.h"
 #include "brave/components/ipfs/ipfs_utils.h"
 #include "brave/components/ipfs/pref_names.h"
 #include "chrome/browser/profiles/profile.h"
@@ -63,6 +73,137 @@ class FakeIpfsService : public ipfs::IpfsService {
   bool launch_result_ = true;
 };
 
+// Answers directory imports like the daemon would and fails the add request
+// with the given number once.
+class FakeIpfsDaemon {
+ public:
+  explicit FakeIpfsDaemon(int failing_add_request)
+      : failing_add_request_(failing_add_request) {}
+
+  std::unique_ptr<net::test_server::HttpResponse> HandleRequest(
+      const net::test_server::HttpRequest& request) {
+    const GURL gurl = request.GetURL();
+    auto http_response =
+        std::make_unique<net::test_server::BasicHttpResponse>();
+    http_response->set_content_type("application/json");
+    base::AutoLock lock(lock_);
+    if (gurl.path_piece() == ipfs::kImportAddPath) {
+      if (++add_requests_ == failing_add_request_) {
+        failed_add_bytes_ += request.content.size();
+        http_response->set_code(net::HTTP_INTERNAL_SERVER_ERROR);
+        return http_response;
+      }
+      add_bytes_ += request.content.size();
+      http_response->set_code(net::HTTP_OK);
+      http_response->set_content(GetAddResponse(request.content));
+      return http_response;
+    }
+
+    if (gurl.path_piece() == ipfs::kImportObjectPutPath) {
+      const std::string kLinkName = "\"Name\":";
+      for (size_t start = request.content.find(kLinkName);
+           start != std::string::npos;
+           start = request.content.find(kLinkName, start + 1)) {
+        ++linked_objects_;
+      }
+      http_response->set_code(net::HTTP_OK);
+      http_response->set_content(base::StringPrintf(
+          R"({"Hash":"QmDirectory%d","Links":[]})", ++put_requests_));
+      return http_response;
+    }
+
+    if (gurl.path_piece() == ipfs::kImportMakeDirectoryPath ||
+        gurl.path_piece() == ipfs::kImportCopyPath) {
+      http_response->set_code(net::HTTP_OK);
+      return http_response;
+    }
+
+    return nullptr;
+  }
+
+  int add_requests() {
+    base::AutoLock lock(lock_);
+    return add_requests_;
+  }
+
+  int put_requests() {
+    base::AutoLock lock(lock_);
+    return put_requests_;
+  }
+
+  int linked_objects() {
+    base::AutoLock lock(lock_);
+    return linked_objects_;
+  }
+
+  size_t add_bytes() {
+    base::AutoLock lock(lock_);
+    return add_bytes_;
+  }
+
+  size_t failed_add_bytes() {
+    base::AutoLock lock(lock_);
+    return failed_add_bytes_;
+  }
+
+ private:
+  // Returns an object for every file and directory of the request, including
+  // the parent directories which are only implied by the paths.
+  std::string GetAddResponse(const std::string& content) {
+    const std::string kFilename = "filename=\"";
+    std::set<std::string> names;
+    for (size_t start = content.find(kFilename); start != std::string::npos;
+         start = content.find(kFilename, start)) {
+      start += kFilename.size();
+      size_t end = content.find('"', start);
+      std::string name = content.substr(start, end - start);
+      for (size_t separator = name.find('/'); separator != std::string::npos;
+           separator = name.find('/', separator + 1)) {
+        names.insert(name.substr(0, separator));
+      }
+      names.insert(name);
+    }
+
+    std::string response;
+    for (const auto& name : names) {
+      response += base::StringPrintf(
+          R"({"Name":"%s","Hash":"Qm%d%s","Size":"1"})"
+          "\n",
+          name.c_str(), add_requests_,
+          base::NumberToString(
+              base::FastHash(base::as_bytes(base::make_span(name))))
+              .c_str());
+    }
+    return response;
+  }
+
+  base::Lock lock_;
+  const int failing_add_request_;
+  int add_requests_ = 0;
+  int put_requests_ = 0;
+  int linked_objects_ = 0;
+  size_t add_bytes_ = 0;
+  size_t failed_add_bytes_ = 0;
+};
+
+class ImportProgressObserver : public ipfs::IpfsServiceObserver {
+ public:
+  void OnImportProgress(const base::FilePath& path,
+                        int64_t uploaded_bytes,
+                        int64_t total_bytes) override {
+    EXPECT_LE(uploaded_bytes, total_bytes);
+    uploaded_bytes_ = uploaded_bytes;
+    total_bytes_ = total_bytes;
+  }
+
+  int64_t uploaded_bytes() const { return uploaded_bytes_; }
+  int64_t total_bytes() const { return total_bytes_; }
+
+ private:
+  int64_t uploaded_bytes_ = 0;
+  int64_t total_bytes_ = 0;
+};
+
 }  // namespace
 
 namespace ipfs {
@@ -1025,4 +1166,98 @@ IN_PROC_BROWSER_TEST_F(IpfsServiceBrowserTest, ImportDirectoryToIpfsSuccess) {
   WaitForRequest();
 }
 
+IN_PROC_BROWSER_TEST_F(IpfsServiceBrowserTest,
+                       ImportLargeDirectoryToIpfsWithFailedBatch) {
+  const int kDirectories = 30;
+  const int kFilesPerDirectory = 100;
+  const std::string kFileContent(1024, 'a');
+  base::ScopedTempDir temp_dir;
+  base::FilePath import_path;
+  {
+    base::ScopedAllowBlockingForTesting allow_blocking;
+    ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+    import_path = temp_dir.GetPath().AppendASCII("import");
+    for (int directory = 0; directory < kDirectories; ++directory) {
+      base::FilePath directory_path =
+          import_path.AppendASCII(base::NumberToString(directory));
+      ASSERT_TRUE(base::CreateDirectory(directory_path));
+      for (int file = 0; file < kFilesPerDirectory; ++file) {
+        ASSERT_TRUE(base::WriteFile(
+            directory_path.AppendASCII(base::NumberToString(file)),
+            kFileContent));
+      }
+    }
+  }
+
+  // One of the four batches fails once and is sent again.
+  FakeIpfsDaemon daemon(2);
+  ResetTestServer(base::BindRepeating(&FakeIpfsDaemon::HandleRequest,
+                                      base::Unretained(&daemon)));
+  ImportProgressObserver observer;
+  ipfs_service()->AddObserver(&observer);
+
+  base::ElapsedTimer timer;
+  ipfs_service()->ImportDirectoryToIpfs(
+      import_path,
+      base::BindOnce(&IpfsServiceBrowserTest::OnImportCompletedSuccess,
+                     base::Unretained(this)));
+  WaitForRequest();
+  const base::TimeDelta elapsed = timer.Elapsed();
+  ipfs_service()->RemoveObserver(&observer);
+
+  const int64_t total_bytes =
+      kDirectories * kFilesPerDirectory * kFileContent.size();
+  EXPECT_EQ(5, daemon.add_requests());
+  // The root and the directories split between batches are linked once each.
+  EXPECT_GT(daemon.put_requests(), 0);
+  EXPECT_LT(daemon.put_requests(), 5);
+  EXPECT_GT(daemon.failed_add_bytes(), 0u);
+  EXPECT_LT(daemon.failed_add_bytes(), daemon.add_bytes() / 2);
+  EXPECT_EQ(total_bytes, observer.total_bytes());
+  EXPECT_EQ(total_bytes, observer.uploaded_bytes());
+
+  VLOG(1) << "Imported " << kDirectories * kFilesPerDirectory << " files in "
+          << elapsed.InMilliseconds() << "ms, re-sent "
+          << daemon.failed_add_bytes() << " of " << daemon.add_bytes()
+          << " bytes";
+
+  base::ScopedAllowBlockingForTesting allow_blocking;
+  ASSERT_TRUE(temp_dir.Delete());
+}
+
+IN_PROC_BROWSER_TEST_F(IpfsServiceBrowserTest, ImportFlatDirectoryToIpfs) {
+  const int kFiles = 10000;
+  base::ScopedTempDir temp_dir;
+  base::FilePath import_path;
+  {
+    base::ScopedAllowBlockingForTesting allow_blocking;
+    ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+    import_path = temp_dir.GetPath().AppendASCII("import");
+    ASSERT_TRUE(base::CreateDirectory(import_path));
+    for (int file = 0; file < kFiles; ++file) {
+      ASSERT_TRUE(base::WriteFile(
+          import_path.AppendASCII(base::NumberToString(file)), "a"));
+    }
+  }
+
+  FakeIpfsDaemon daemon(0);
+  ResetTestServer(base::BindRepeating(&FakeIpfsDaemon::HandleRequest,
+                                      base::Unretained(&daemon)));
+
+  ipfs_service()->ImportDirectoryToIpfs(
+      import_path,
+      base::BindOnce(&IpfsServiceBrowserTest::OnImportCompletedSuccess,
+                     base::Unretained(this)));
+  WaitForRequest();
+
+  // The files are split across batches but the root is only linked once,
+  // with all of them.
+  EXPECT_EQ(11, daemon.add_requests());
+  EXPECT_EQ(1, daemon.put_requests());
+  EXPECT_EQ(kFiles, daemon.linked_objects());
+
+  base::ScopedAllowBlockingForTesting allow_blocking;
+  ASSERT_TRUE(temp_dir.Delete());
+}
+
 }  // namespace ipfs
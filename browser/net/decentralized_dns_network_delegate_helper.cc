@@ -5,15 +5,20 @@
 
 #include "brave/browser/net/decentralized_dns_network_delegate_helper.h"
 
+#include <utility>
 #include <vector>
 
 #include "net/base/net_errors.h"
 
+#include "base/bind.h"
 #include "brave/browser/brave_wallet/brave_wallet_service_factory.h"
+#include "brave/browser/decentralized_dns/decentralized_dns_service_factory.h"
 #include "brave/components/brave_wallet/browser/brave_wallet_service.h"
 #include "brave/components/brave_wallet/browser/brave_wallet_utils.h"
 #include "brave/components/brave_wallet/browser/eth_json_rpc_controller.h"
 #include "brave/components/decentralized_dns/constants.h"
+#include "brave/components/decentralized_dns/decentralized_dns_service.h"
+#include "brave/components/decentralized_dns/resolution_cache.h"
 #include "brave/components/decentralized_dns/utils.h"
 #include "chrome/browser/browser_process.h"
 #include "content/public/browser/browser_context.h"
@@ -26,6 +31,16 @@ std::string GetValue(const std::vector<std::string>& arr, RecordKeys key) {
   return arr[static_cast<size_t>(key)];
 }
 
+bool StartUnstoppableDomainsResolution(
+    brave_wallet::EthJsonRpcController* controller,
+    const std::string& host,
+    ResolutionCache::ResolveCallback callback) {
+  return controller->UnstoppableDomainsProxyReaderGetMany(
+      kProxyReaderContractAddress, host,
+      std::vector<std::string>(std::begin(kRecordKeys), std::end(kRecordKeys)),
+      std::move(callback));
+}
+
 }  // namespace
 
 int OnBeforeURLRequest_DecentralizedDnsPreRedirectWork(
@@ -45,10 +60,23 @@ int OnBeforeURLRequest_DecentralizedDnsPreRedirectWork(
       return net::OK;
     }
 
-    service->controller()->UnstoppableDomainsProxyReaderGetMany(
-        kProxyReaderContractAddress, ctx->request_url.host(),
-        std::vector<std::string>(std::begin(kRecordKeys),
-                                 std::end(kRecordKeys)),
+    auto* dns_service =
+        DecentralizedDnsServiceFactory::GetForContext(ctx->browser_context);
+    if (!dns_service) {
+      // Resolve without caching.
+      StartUnstoppableDomainsResolution(
+          service->controller(), ctx->request_url.host(),
+          base::BindOnce(&OnBeforeURLRequest_DecentralizedDnsRedirectWork,
+                         next_callback, ctx));
+      return net::ERR_IO_PENDING;
+    }
+
+    // Starter is run synchronously if needed, so |controller| outlives it.
+    dns_service->resolution_cache()->Resolve(
+        ctx->request_url.host(),
+        base::BindOnce(&StartUnstoppableDomainsResolution,
+                       base::Unretained(service->controller()),
+                       ctx->request_url.host()),
         base::BindOnce(&OnBeforeURLRequest_DecentralizedDnsRedirectWork,
                        next_callback, ctx));
 
@@ -35,6 +35,9 @@ class BraveUptimeTracker {
   ~BraveUptimeTracker();
 
   static void CreateInstance(PrefService* local_state);
+  // Destroys the instance, writing out uptime not stored in prefs yet. Must be
+  // called before local state is torn down.
+  static void DestroyInstance();
 
   static void RegisterPrefs(PrefRegistrySimple* registry);
 
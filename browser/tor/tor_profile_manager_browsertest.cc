@@ -19,8 +19,10 @@
 #include "chrome/browser/browser_process.h"
 #include "chrome/browser/content_settings/host_content_settings_map_factory.h"
 #include "chrome/browser/profiles/profile_manager.h"
+#include "chrome/browser/ui/browser.h"
 #include "chrome/browser/ui/browser_list.h"
 #include "chrome/test/base/in_process_browser_test.h"
+#include "chrome/test/base/ui_test_utils.h"
 #include "components/bookmarks/browser/bookmark_model.h"
 #include "components/bookmarks/common/bookmark_pref_names.h"
 #include "components/bookmarks/test/bookmark_test_helpers.h"
@@ -250,6 +252,26 @@ IN_PROC_BROWSER_TEST_F(TorProfileManagerTest, CloseLastTorWindow) {
   TorProfileManager::CloseTorProfileWindows(tor_profile);
 }
 
+IN_PROC_BROWSER_TEST_F(TorProfileManagerTest, PrewarmCircuitOnNavigation) {
+  Profile* parent_profile = ProfileManager::GetActiveUserProfile();
+  Profile* tor_profile =
+      SwitchToTorProfile(parent_profile, GetTorLauncherFactory());
+  ASSERT_TRUE(tor_profile->IsTor());
+  Browser* tor_browser = BrowserList::GetInstance()->get(1);
+  ASSERT_EQ(tor_browser->profile(), tor_profile);
+
+  // A new tab asks for a circuit for its isolation key as soon as it starts
+  // navigating.
+  testing::Mock::AllowLeak(GetTorLauncherFactory());
+  EXPECT_CALL(*GetTorLauncherFactory(), PrewarmCircuit("example.com"))
+      .Times(1);
+  ui_test_utils::NavigateToURLWithDisposition(
+      tor_browser, GURL("https://www.example.com/"),
+      WindowOpenDisposition::NEW_FOREGROUND_TAB,
+      ui_test_utils::BROWSER_TEST_NONE);
+  testing::Mock::VerifyAndClearExpectations(GetTorLauncherFactory());
+}
+
 #if BUILDFLAG(ENABLE_EXTENSIONS)
 class TorProfileManagerExtensionTest : public extensions::ExtensionBrowserTest {
  public:
@@ -59,6 +59,7 @@ void AdsService::RegisterProfilePrefs(
   registry->RegisterIntegerPref(ads::prefs::kCatalogVersion, 0);
   registry->RegisterInt64Pref(ads::prefs::kCatalogPing, 0);
   registry->RegisterInt64Pref(ads::prefs::kCatalogLastUpdated, 0);
+  registry->RegisterStringPref(ads::prefs::kCatalogCampaignDigests, "");
 
   registry->RegisterStringPref(ads::prefs::kEpsilonGreedyBanditArms, "");
   registry->RegisterStringPref(ads::prefs::kEpsilonGreedyBanditEligibleSegments,
@@ -7,15 +7,13 @@
 
 #include <tuple>
 
-#include "base/bind.h"
 #include "base/containers/flat_set.h"
 #include "base/json/json_reader.h"
 #include "base/logging.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
-#include "base/task/post_task.h"
-#include "base/task/thread_pool.h"
+#include "base/trace_event/memory_usage_estimator.h"
 #include "base/values.h"
 #include "brave/components/brave_perf_predictor/browser/bandwidth_linreg_parameters.h"
 #include "components/grit/brave_components_resources.h"
@@ -84,19 +82,6 @@ ParseMappings(const base::StringPiece entities, bool discard_irrelevant) {
   return std::make_tuple(entity_by_domain, entity_by_root_domain);
 }
 
-std::tuple<base::flat_map<std::string, std::string>,
-           base::flat_map<std::string, std::string>>
-ParseFromResource(int resource_id) {
-  // TODO(AndriusA): insert trace event here
-  SCOPED_UMA_HISTOGRAM_TIMER(
-      "Brave.Savings.NamedThirdPartyRegistry.LoadTimeMS");
-  auto& resource_bundle = ui::ResourceBundle::GetSharedInstance();
-  std::string data_resource =
-      resource_bundle.LoadDataResourceString(resource_id);
-  // Parse resource, discarding irrelevant entities
-  return ParseMappings(data_resource, true);
-}
-
 }  // namespace
 
 bool NamedThirdPartyRegistry::LoadMappings(const base::StringPiece entities,
@@ -104,6 +89,7 @@ bool NamedThirdPartyRegistry::LoadMappings(const base::StringPiece entities,
   // Reset previous mappings
   entity_by_domain_.clear();
   entity_by_root_domain_.clear();
+  index_.Reset();
   initialized_ = false;
 
   tie(entity_by_domain_, entity_by_root_domain_) =
@@ -115,13 +101,20 @@ bool NamedThirdPartyRegistry::LoadMappings(const base::StringPiece entities,
   return true;
 }
 
-void NamedThirdPartyRegistry::UpdateMappings(
-    std::tuple<base::flat_map<std::string, std::string>,
-               base::flat_map<std::string, std::string>> entity_mappings) {
-  tie(entity_by_domain_, entity_by_root_domain_) = entity_mappings;
-  VLOG(2) << "Loaded " << entity_by_domain_.size() << " mappings by domain and "
-          << entity_by_root_domain_.size() << " by root domain; size";
+bool NamedThirdPartyRegistry::LoadIndex(const base::StringPiece index) {
+  // Reset previous mappings
+  entity_by_domain_.clear();
+  entity_by_root_domain_.clear();
+  initialized_ = false;
+
+  if (!index_.Init(index) || index_.domain_count() == 0 ||
+      index_.root_domain_count() == 0)
+    return false;
+
+  VLOG(2) << "Loaded " << index_.domain_count() << " mappings by domain and "
+          << index_.root_domain_count() << " by root domain";
   initialized_ = true;
+  return true;
 }
 
 base::Optional<std::string> NamedThirdPartyRegistry::GetThirdParty(
@@ -136,6 +129,19 @@ base::Optional<std::string> NamedThirdPartyRegistry::GetThirdParty(
     return base::nullopt;
 
   if (url.has_host()) {
+    if (index_.IsValid()) {
+      auto entity = index_.FindByDomain(url.host_piece());
+      if (!entity) {
+        entity = index_.FindByRootDomain(
+            net::registry_controlled_domains::GetDomainAndRegistry(
+                url,
+                net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES));
+      }
+      if (entity)
+        return entity->as_string();
+      return base::nullopt;
+    }
+
     auto domain_entry = entity_by_domain_.find(url.host());
     if (domain_entry != entity_by_domain_.end())
       return domain_entry->second;
@@ -151,16 +157,25 @@ base::Optional<std::string> NamedThirdPartyRegistry::GetThirdParty(
   return base::nullopt;
 }
 
+size_t NamedThirdPartyRegistry::EstimateMemoryUsage() const {
+  return base::trace_event::EstimateMemoryUsage(entity_by_domain_) +
+         base::trace_event::EstimateMemoryUsage(entity_by_root_domain_);
+}
+
 NamedThirdPartyRegistry::NamedThirdPartyRegistry() = default;
 
 NamedThirdPartyRegistry::~NamedThirdPartyRegistry() = default;
 
 void NamedThirdPartyRegistry::InitializeDefault() {
-  base::PostTaskAndReplyWithResult(
-      FROM_HERE, {base::ThreadPool(), base::MayBlock()},
-      base::BindOnce(&ParseFromResource, IDR_THIRD_PARTY_ENTITIES),
-      base::BindOnce(&NamedThirdPartyRegistry::UpdateMappings,
-                     weak_factory_.GetWeakPtr()));
+  SCOPED_UMA_HISTOGRAM_TIMER(
+      "Brave.Savings.NamedThirdPartyRegistry.LoadTimeMS");
+  // The index is stored uncompressed so that it can be used in place from the
+  // memory mapped resource pack, without parsing or copying
+  const base::StringPiece index =
+      ui::ResourceBundle::GetSharedInstance().GetRawDataResource(
+          IDR_THIRD_PARTY_ENTITIES_INDEX);
+  if (!LoadIndex(index))
+    LOG(ERROR) << "Cannot load the third-party entities index";
 }
 
 }  // namespace brave_perf_predictor
@@ -7,11 +7,10 @@
 #define BRAVE_COMPONENTS_BRAVE_PERF_PREDICTOR_BROWSER_NAMED_THIRD_PARTY_REGISTRY_H_
 
 #include <string>
-#include <tuple>
 
 #include "base/containers/flat_map.h"
-#include "base/memory/weak_ptr.h"
 #include "base/values.h"
+#include "brave/components/brave_perf_predictor/browser/third_party_entities_index.h"
 #include "components/keyed_service/core/keyed_service.h"
 
 namespace brave_perf_predictor {
@@ -31,23 +30,25 @@ class NamedThirdPartyRegistry : public KeyedService {
   // entities not relevant to the bandwith prediction model (i.e. those not
   // seen in training the model).
   bool LoadMappings(const base::StringPiece entities, bool discard_irrelevant);
-  // Default initialization - asynchronously load from bundled resource
+  // Use the binary index compiled from the bundled entities at build time,
+  // see ThirdPartyEntitiesIndex. |index| must outlive the registry.
+  bool LoadIndex(const base::StringPiece index);
+  // Default initialization - load the index from the bundled resource
   void InitializeDefault();
   base::Optional<std::string> GetThirdParty(
       const base::StringPiece domain) const;
+  // Heap memory held by the mappings. The index is used in place and is not
+  // counted.
+  size_t EstimateMemoryUsage() const;
 
  private:
   bool IsInitialized() const { return initialized_; }
   void MarkInitialized(bool initialized) { initialized_ = initialized; }
-  void UpdateMappings(
-      std::tuple<base::flat_map<std::string, std::string>,
-                 base::flat_map<std::string, std::string>> entity_mappings);
 
   bool initialized_ = false;
   base::flat_map<std::string, std::string> entity_by_domain_;
   base::flat_map<std::string, std::string> entity_by_root_domain_;
-
-  base::WeakPtrFactory<NamedThirdPartyRegistry> weak_factory_{this};
+  ThirdPartyEntitiesIndex index_;
 };
 
 }  // namespace brave_perf_predictor
@@ -5,10 +5,17 @@
 
 #include "brave/components/brave_perf_predictor/browser/named_third_party_registry.h"
 
+#include <string>
+
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/json/json_reader.h"
 #include "base/path_service.h"
+#include "base/timer/elapsed_timer.h"
+#include "base/values.h"
+#include "components/grit/brave_components_resources.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "ui/base/resource/resource_bundle.h"
 
 namespace brave_perf_predictor {
 
@@ -55,6 +62,11 @@ std::string LoadFile() {
   return value;
 }
 
+base::StringPiece LoadIndex() {
+  return ui::ResourceBundle::GetSharedInstance().GetRawDataResource(
+      IDR_THIRD_PARTY_ENTITIES_INDEX);
+}
+
 }  // namespace
 
 TEST(NamedThirdPartyRegistryTest, HandlesEmptyJSON) {
@@ -119,4 +131,85 @@ TEST(NamedThirdPartyRegistryTest, HandlesUnrecognisedThirdPartyTest) {
   EXPECT_FALSE(entity.has_value());
 }
 
+TEST(NamedThirdPartyRegistryTest, LoadsIndex) {
+  NamedThirdPartyRegistry extractor;
+  EXPECT_TRUE(extractor.LoadIndex(LoadIndex()));
+  EXPECT_EQ(extractor.EstimateMemoryUsage(), 0u);
+
+  auto entity = extractor.GetThirdParty("https://test.m.facebook.com");
+  ASSERT_TRUE(entity.has_value());
+  EXPECT_EQ(entity.value(), "Facebook");
+}
+
+TEST(NamedThirdPartyRegistryTest, HandlesInvalidIndex) {
+  NamedThirdPartyRegistry extractor;
+  EXPECT_FALSE(extractor.LoadIndex(""));
+  EXPECT_FALSE(extractor.LoadIndex(R"([{"name":"Google Analytics"}])"));
+
+  const base::StringPiece index = LoadIndex();
+  EXPECT_FALSE(extractor.LoadIndex(index.substr(0, index.size() - 1)));
+  EXPECT_FALSE(
+      extractor.GetThirdParty("https://google-analytics.com").has_value());
+}
+
+TEST(NamedThirdPartyRegistryTest, IndexMatchesJSONForEveryDomain) {
+  const std::string dataset = LoadFile();
+  NamedThirdPartyRegistry json_extractor;
+  ASSERT_TRUE(json_extractor.LoadMappings(dataset, true));
+  NamedThirdPartyRegistry index_extractor;
+  ASSERT_TRUE(index_extractor.LoadIndex(LoadIndex()));
+
+  base::Optional<base::Value> document = base::JSONReader::Read(dataset);
+  ASSERT_TRUE(document && document->is_list());
+
+  size_t domain_count = 0;
+  for (const auto& entity : document->GetList()) {
+    const auto* domains = entity.FindListPath("domains");
+    if (!domains)
+      continue;
+
+    for (const auto& domain : domains->GetList()) {
+      // Check both the exact domain and the root domain lookups
+      for (const std::string& url :
+           {"https://" + domain.GetString() + "/",
+            "https://subdomain." + domain.GetString() + "/"}) {
+        EXPECT_EQ(json_extractor.GetThirdParty(url),
+                  index_extractor.GetThirdParty(url))
+            << url;
+      }
+      domain_count++;
+    }
+  }
+  EXPECT_GT(domain_count, 0u);
+
+  EXPECT_EQ(json_extractor.GetThirdParty("http://example.com"),
+            index_extractor.GetThirdParty("http://example.com"));
+}
+
+TEST(NamedThirdPartyRegistryTest, BenchmarkLoadTimeAndMemory) {
+  const std::string dataset = LoadFile();
+  constexpr int kIterations = 20;
+
+  NamedThirdPartyRegistry json_extractor;
+  base::ElapsedTimer json_timer;
+  for (int i = 0; i < kIterations; i++)
+    ASSERT_TRUE(json_extractor.LoadMappings(dataset, true));
+  const base::TimeDelta json_load_time = json_timer.Elapsed() / kIterations;
+
+  NamedThirdPartyRegistry index_extractor;
+  base::ElapsedTimer index_timer;
+  for (int i = 0; i < kIterations; i++)
+    ASSERT_TRUE(index_extractor.LoadIndex(LoadIndex()));
+  const base::TimeDelta index_load_time = index_timer.Elapsed() / kIterations;
+
+  VLOG(1) << "JSON: " << json_load_time.InMicroseconds() << "us to load, "
+          << json_extractor.EstimateMemoryUsage() << " heap bytes";
+  VLOG(1) << "Index: " << index_load_time.InMicroseconds() << "us to load, "
+          << index_extractor.EstimateMemoryUsage() << " heap bytes, "
+          << LoadIndex().size() << " mapped bytes";
+
+  EXPECT_LT(index_extractor.EstimateMemoryUsage(),
+            json_extractor.EstimateMemoryUsage());
+}
+
 }  // namespace brave_perf_predictor
@@ -0,0 +1,164 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_perf_predictor/browser/third_party_entities_index.h"
+
+#include "base/big_endian.h"
+#include "base/logging.h"
+#include "base/numerics/checked_math.h"
+#include "base/stl_util.h"
+
+namespace brave_perf_predictor {
+
+namespace {
+
+constexpr char kMagic[] = {'T', 'P', 'E', 'I'};
+constexpr uint32_t kVersion = 1;
+
+constexpr size_t kHeaderSize = sizeof(kMagic) + 5 * sizeof(uint32_t);
+// uint64 domain hash followed by uint32 entity id
+constexpr size_t kDomainEntrySize = sizeof(uint64_t) + sizeof(uint32_t);
+// uint32 name offset followed by uint32 name length
+constexpr size_t kEntityEntrySize = 2 * sizeof(uint32_t);
+
+constexpr uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ULL;
+constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+// Splits |size| bytes off the front of |data|, failing if it is too short.
+bool TakePrefix(base::StringPiece* data,
+                base::CheckedNumeric<size_t> size,
+                base::StringPiece* out) {
+  size_t length;
+  if (!size.AssignIfValid(&length) || data->size() < length)
+    return false;
+  *out = data->substr(0, length);
+  data->remove_prefix(length);
+  return true;
+}
+
+}  // namespace
+
+ThirdPartyEntitiesIndex::ThirdPartyEntitiesIndex() = default;
+
+ThirdPartyEntitiesIndex::~ThirdPartyEntitiesIndex() = default;
+
+bool ThirdPartyEntitiesIndex::Init(base::StringPiece data) {
+  Reset();
+
+  base::StringPiece header;
+  if (!TakePrefix(&data, kHeaderSize, &header) ||
+      header.substr(0, sizeof(kMagic)) !=
+          base::StringPiece(kMagic, sizeof(kMagic))) {
+    LOG(ERROR) << "Malformed third-party entities index";
+    return false;
+  }
+
+  uint32_t fields[5];
+  for (size_t i = 0; i < base::size(fields); ++i) {
+    base::ReadBigEndian(header.data() + sizeof(kMagic) + i * sizeof(uint32_t),
+                        &fields[i]);
+  }
+  const uint32_t version = fields[0];
+  if (version != kVersion) {
+    LOG(ERROR) << "Unsupported third-party entities index version "
+               << version;
+    return false;
+  }
+
+  base::StringPiece domains, root_domains, entities, names;
+  if (!TakePrefix(&data, base::CheckMul(fields[1], kDomainEntrySize),
+                  &domains) ||
+      !TakePrefix(&data, base::CheckMul(fields[2], kDomainEntrySize),
+                  &root_domains) ||
+      !TakePrefix(&data, base::CheckMul(fields[3], kEntityEntrySize),
+                  &entities) ||
+      !TakePrefix(&data, fields[4], &names) || !data.empty()) {
+    LOG(ERROR) << "Truncated third-party entities index";
+    return false;
+  }
+
+  header_ = header;
+  domains_ = domains;
+  root_domains_ = root_domains;
+  entities_ = entities;
+  names_ = names;
+  domain_count_ = fields[1];
+  root_domain_count_ = fields[2];
+  entity_count_ = fields[3];
+  return true;
+}
+
+void ThirdPartyEntitiesIndex::Reset() {
+  *this = ThirdPartyEntitiesIndex();
+}
+
+base::Optional<base::StringPiece> ThirdPartyEntitiesIndex::FindByDomain(
+    base::StringPiece domain) const {
+  return Find(domains_, domain_count_, domain);
+}
+
+base::Optional<base::StringPiece> ThirdPartyEntitiesIndex::FindByRootDomain(
+    base::StringPiece root_domain) const {
+  return Find(root_domains_, root_domain_count_, root_domain);
+}
+
+// static
+uint64_t ThirdPartyEntitiesIndex::HashDomain(base::StringPiece domain) {
+  uint64_t hash = kFnvOffsetBasis;
+  for (const char c : domain) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+base::Optional<base::StringPiece> ThirdPartyEntitiesIndex::Find(
+    base::StringPiece entries,
+    size_t count,
+    base::StringPiece domain) const {
+  if (!IsValid())
+    return base::nullopt;
+
+  const uint64_t hash = HashDomain(domain);
+
+  size_t low = 0;
+  size_t high = count;
+  while (low < high) {
+    const size_t mid = low + (high - low) / 2;
+    const char* entry = entries.data() + mid * kDomainEntrySize;
+
+    uint64_t entry_hash;
+    base::ReadBigEndian(entry, &entry_hash);
+    if (entry_hash < hash) {
+      low = mid + 1;
+    } else if (entry_hash > hash) {
+      high = mid;
+    } else {
+      uint32_t entity_id;
+      base::ReadBigEndian(entry + sizeof(uint64_t), &entity_id);
+      return GetEntityName(entity_id);
+    }
+  }
+
+  return base::nullopt;
+}
+
+base::Optional<base::StringPiece> ThirdPartyEntitiesIndex::GetEntityName(
+    uint32_t entity_id) const {
+  if (entity_id >= entity_count_)
+    return base::nullopt;
+
+  const char* entry = entities_.data() + entity_id * kEntityEntrySize;
+  uint32_t offset;
+  uint32_t length;
+  base::ReadBigEndian(entry, &offset);
+  base::ReadBigEndian(entry + sizeof(uint32_t), &length);
+  if (offset > names_.size() || length > names_.size() - offset)
+    return base::nullopt;
+
+  return names_.substr(offset, length);
+}
+
+}  // namespace brave_perf_predictor
@@ -0,0 +1,61 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_PERF_PREDICTOR_BROWSER_THIRD_PARTY_ENTITIES_INDEX_H_
+#define BRAVE_COMPONENTS_BRAVE_PERF_PREDICTOR_BROWSER_THIRD_PARTY_ENTITIES_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/optional.h"
+#include "base/strings/string_piece.h"
+
+namespace brave_perf_predictor {
+
+// Read-only view over the binary third-party entities index compiled at build
+// time by resources/generate_entities_index.py, which documents the format.
+// Domains are looked up by hash with a binary search directly over the
+// underlying buffer, so the index neither parses nor copies the data.
+class ThirdPartyEntitiesIndex {
+ public:
+  ThirdPartyEntitiesIndex();
+  ~ThirdPartyEntitiesIndex();
+
+  // Validates |data| and points the index at it. |data| must outlive the
+  // index, e.g. a resource mapped from a data pack.
+  bool Init(base::StringPiece data);
+  void Reset();
+  bool IsValid() const { return !header_.empty(); }
+
+  base::Optional<base::StringPiece> FindByDomain(
+      base::StringPiece domain) const;
+  base::Optional<base::StringPiece> FindByRootDomain(
+      base::StringPiece root_domain) const;
+
+  size_t domain_count() const { return domain_count_; }
+  size_t root_domain_count() const { return root_domain_count_; }
+
+  // 64-bit FNV-1a, as used by the build step.
+  static uint64_t HashDomain(base::StringPiece domain);
+
+ private:
+  base::Optional<base::StringPiece> Find(base::StringPiece entries,
+                                         size_t count,
+                                         base::StringPiece domain) const;
+  base::Optional<base::StringPiece> GetEntityName(uint32_t entity_id) const;
+
+  base::StringPiece header_;
+  base::StringPiece domains_;
+  base::StringPiece root_domains_;
+  base::StringPiece entities_;
+  base::StringPiece names_;
+  size_t domain_count_ = 0;
+  size_t root_domain_count_ = 0;
+  size_t entity_count_ = 0;
+};
+
+}  // namespace brave_perf_predictor
+
+#endif  // BRAVE_COMPONENTS_BRAVE_PERF_PREDICTOR_BROWSER_THIRD_PARTY_ENTITIES_INDEX_H_
@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 The Brave Authors. All rights reserved.
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this file,
+# You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+"""Compiles the third-party entities JSON into the binary index read by
+ThirdPartyEntitiesIndex (see browser/third_party_entities_index.h).
+
+The mappings are built exactly like NamedThirdPartyRegistry::LoadMappings
+with |discard_irrelevant| set, so the format below must be kept in sync with
+the C++ reader. All integers are big-endian.
+
+  header:       magic "TPEI", uint32 version, uint32 domain count,
+                uint32 root domain count, uint32 entity count,
+                uint32 names size
+  domains:      (uint64 domain hash, uint32 entity id), sorted by hash
+  root domains: (uint64 domain hash, uint32 entity id), sorted by hash
+  entities:     (uint32 name offset, uint32 name length)
+  names:        entity names, not NUL-terminated
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+MAGIC = b'TPEI'
+VERSION = 1
+
+FNV_OFFSET_BASIS = 0xcbf29ce484222325
+FNV_PRIME = 0x100000001b3
+
+# Flags used by //net/base/registry_controlled_domains/*.gperf
+PSL_EXCEPTION_RULE = 1
+PSL_WILDCARD_RULE = 2
+
+IPV4_RE = re.compile(r'^[0-9]+(\.[0-9]+){3}$')
+
+
+def hash_domain(domain):
+    """64-bit FNV-1a, matches ThirdPartyEntitiesIndex::HashDomain."""
+    value = FNV_OFFSET_BASIS
+    for byte in bytearray(domain.encode('utf-8')):
+        value ^= byte
+        value = (value * FNV_PRIME) & 0xffffffffffffffff
+    return value
+
+
+def load_public_suffix_rules(path):
+    rules = {}
+    in_rules = False
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line == '%%':
+                if in_rules:
+                    break
+                in_rules = True
+                continue
+            if not in_rules or not line:
+                continue
+            name, flags = line.rsplit(',', 1)
+            rules[name.strip()] = int(flags)
+    return rules
+
+
+def get_domain_and_registry(host, rules):
+    """Mirrors net::registry_controlled_domains::GetDomainAndRegistry with
+    INCLUDE_PRIVATE_REGISTRIES and unknown registries excluded."""
+    host = host.lower().rstrip('.')
+    if not host or IPV4_RE.match(host):
+        return ''
+
+    labels = host.split('.')
+    registry_labels = 0
+    for i in range(len(labels)):
+        flags = rules.get('.'.join(labels[i:]))
+        if flags is None:
+            continue
+        if flags & PSL_WILDCARD_RULE and i > 0:
+            registry_labels = 0 if i == 1 else len(labels) - i + 1
+        elif flags & PSL_EXCEPTION_RULE:
+            registry_labels = len(labels) - i - 1
+        else:
+            registry_labels = 0 if i == 0 else len(labels) - i
+        break
+
+    if registry_labels == 0 or registry_labels >= len(labels):
+        return ''
+    return '.'.join(labels[-(registry_labels + 1):])
+
+
+def load_relevant_entities(path):
+    with open(path) as f:
+        source = f.read()
+    block = re.search(r'relevant_entities\{(.*?)\};', source, re.DOTALL)
+    if not block:
+        raise ValueError('relevant_entities not found in %s' % path)
+    return set(re.findall(r'"([^"]*)"', block.group(1)))
+
+
+def build_mappings(entities, relevant_entities, rules):
+    entity_by_domain = {}
+    entity_by_root_domain = {}
+
+    for entity in entities:
+        name = entity.get('name')
+        if not isinstance(name, str) or name not in relevant_entities:
+            continue
+        domains = entity.get('domains')
+        if not isinstance(domains, list):
+            continue
+
+        for domain in domains:
+            if not isinstance(domain, str):
+                continue
+            entity_by_domain.setdefault(domain, name)
+
+            root_domain = get_domain_and_registry(domain, rules)
+            existing = entity_by_root_domain.get(root_domain)
+            if existing is not None and existing != name:
+                # If there is a clash at root domain level, neither is correct
+                del entity_by_root_domain[root_domain]
+            else:
+                entity_by_root_domain.setdefault(root_domain, name)
+
+    return entity_by_domain, entity_by_root_domain
+
+
+def pack_entries(mapping, entity_ids):
+    entries = sorted(
+        (hash_domain(domain), entity_ids[name], domain)
+        for domain, name in mapping.items())
+    for previous, current in zip(entries, entries[1:]):
+        if previous[0] == current[0]:
+            raise ValueError('Domain hash collision between %s and %s' %
+                             (previous[2], current[2]))
+    return b''.join(
+        struct.pack('>QI', domain_hash, entity_id)
+        for domain_hash, entity_id, _ in entries)
+
+
+def build_index(entity_by_domain, entity_by_root_domain):
+    names = sorted(
+        set(entity_by_domain.values()) | set(entity_by_root_domain.values()))
+    entity_ids = {name: i for i, name in enumerate(names)}
+
+    entity_table = b''
+    names_blob = b''
+    for name in names:
+        encoded_name = name.encode('utf-8')
+        entity_table += struct.pack('>II', len(names_blob), len(encoded_name))
+        names_blob += encoded_name
+
+    header = MAGIC + struct.pack('>IIIII', VERSION, len(entity_by_domain),
+                                 len(entity_by_root_domain), len(names),
+                                 len(names_blob))
+    return b''.join([
+        header,
+        pack_entries(entity_by_domain, entity_ids),
+        pack_entries(entity_by_root_domain, entity_ids),
+        entity_table,
+        names_blob,
+    ])
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--entities', required=True,
+                        help='third-party-web entities JSON')
+    parser.add_argument('--parameters', required=True,
+                        help='bandwidth_linreg_parameters.h listing the '
+                        'entities relevant to the model')
+    parser.add_argument('--public-suffix-list', required=True,
+                        help='effective_tld_names.gperf')
+    parser.add_argument('--output', required=True)
+    args = parser.parse_args()
+
+    with open(args.entities) as f:
+        entities = json.load(f)
+
+    entity_by_domain, entity_by_root_domain = build_mappings(
+        entities, load_relevant_entities(args.parameters),
+        load_public_suffix_rules(args.public_suffix_list))
+
+    with open(args.output, 'wb') as f:
+        f.write(build_index(entity_by_domain, entity_by_root_domain))
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -274,6 +274,16 @@ bool ProcessPublisher(const GURL& url) {
   return true;
 }
 
+// Checked before the load is parsed and sent to the ledger, which ignores
+// almost every load anyway.
+bool IsProcessedMediaLink(const GURL& url,
+                          const GURL& first_party_url,
+                          const GURL& referrer) {
+  return ledger::Ledger::IsProcessedMediaLink(url.spec(),
+                                              first_party_url.spec(),
+                                              referrer.spec());
+}
+
 std::string GetPrefPath(const std::string& name) {
   return base::StringPrintf("%s.%s", pref_prefix, name.c_str());
 }
@@ -722,7 +732,8 @@ void RewardsServiceImpl::OnPostData(SessionID tab_id,
     return;
   }
 
-  if (!ProcessPublisher(url)) {
+  if (!ProcessPublisher(url) ||
+      !IsProcessedMediaLink(url, first_party_url, referrer)) {
     return;
   }
 
@@ -757,7 +768,8 @@ void RewardsServiceImpl::OnXHRLoad(SessionID tab_id,
     return;
   }
 
-  if (!ProcessPublisher(url)) {
+  if (!ProcessPublisher(url) ||
+      !IsProcessedMediaLink(url, first_party_url, referrer)) {
     return;
   }
 
@@ -62,6 +62,12 @@ class AdBlockBaseService : public BaseBraveShieldsService {
       const std::vector<std::string>& ids,
       const std::vector<std::string>& exceptions);
 
+  // Incremented whenever the rules of any ad-block engine change, so that
+  // results derived from the engines can be cached until then. Safe to call
+  // from any thread.
+  static uint64_t GetEngineGeneration();
+  static void IncrementEngineGeneration();
+
  protected:
   friend class ::AdBlockServiceTest;
   bool Init() override;
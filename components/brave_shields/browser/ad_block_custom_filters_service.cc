@@ -44,6 +44,10 @@ bool AdBlockCustomFiltersService::UpdateCustomFilters(
     return false;
   local_state->SetString(kAdBlockCustomFilters, custom_filters);
 
+  // Invalidate results cached on the UI thread right away rather than once
+  // the engine is swapped, so that a navigation made in the meantime isn't
+  // allowed from a stale verdict.
+  IncrementEngineGeneration();
   GetTaskRunner()->PostTask(
       FROM_HERE,
       base::BindOnce(
@@ -86,6 +90,7 @@ void AdBlockCustomFiltersService::UpdateCustomFiltersOnFileTaskRunner(
     const std::string& custom_filters) {
   DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
   ad_block_client_.reset(new adblock::Engine(custom_filters.c_str()));
+  IncrementEngineGeneration();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
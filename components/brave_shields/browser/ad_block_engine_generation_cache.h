@@ -0,0 +1,79 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_ENGINE_GENERATION_CACHE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_ENGINE_GENERATION_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+
+#include "base/containers/mru_cache.h"
+#include "base/sequence_checker.h"
+
+namespace brave_shields {
+
+// Most recently used cache for values computed from the ad-block engines.
+// Each value is stored along with the AdBlockBaseService::GetEngineGeneration()
+// it was computed with, and is dropped when looked up with any other one.
+// Callers should read the generation before querying the engines, so that a
+// result racing with an engine update is never served afterwards.
+template <class T>
+class AdBlockEngineGenerationCache {
+ public:
+  explicit AdBlockEngineGenerationCache(size_t max_size) : entries_(max_size) {}
+  ~AdBlockEngineGenerationCache() = default;
+
+  AdBlockEngineGenerationCache(const AdBlockEngineGenerationCache&) = delete;
+  AdBlockEngineGenerationCache& operator=(const AdBlockEngineGenerationCache&) =
+      delete;
+
+  // Returns null if there is no value for |key| computed with
+  // |engine_generation|. The pointer is invalidated by the next call.
+  const T* Get(const std::string& key, uint64_t engine_generation) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+    auto it = entries_.Get(key);
+    if (it == entries_.end())
+      return nullptr;
+
+    if (it->second.engine_generation != engine_generation) {
+      entries_.Erase(it);
+      return nullptr;
+    }
+
+    return &it->second.value;
+  }
+
+  void Put(const std::string& key, uint64_t engine_generation, T value) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+    entries_.Put(key, Entry{engine_generation, std::move(value)});
+  }
+
+  void Clear() {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+    entries_.Clear();
+  }
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    uint64_t engine_generation;
+    T value;
+  };
+
+  base::MRUCache<std::string, Entry> entries_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_ENGINE_GENERATION_CACHE_H_
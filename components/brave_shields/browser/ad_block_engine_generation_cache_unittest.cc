@@ -0,0 +1,65 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_engine_generation_cache.h"
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+// npm run test -- brave_unit_tests --filter=AdBlockEngineGenerationCacheTest.*
+
+namespace brave_shields {
+
+TEST(AdBlockEngineGenerationCacheTest, GetReturnsValueForSameGeneration) {
+  AdBlockEngineGenerationCache<std::string> cache(10);
+
+  EXPECT_EQ(nullptr, cache.Get("a", 1));
+
+  cache.Put("a", 1, "value");
+
+  const std::string* value = cache.Get("a", 1);
+  ASSERT_NE(nullptr, value);
+  EXPECT_EQ("value", *value);
+  EXPECT_EQ(nullptr, cache.Get("b", 1));
+}
+
+TEST(AdBlockEngineGenerationCacheTest, GetDropsValueFromOtherGeneration) {
+  AdBlockEngineGenerationCache<std::string> cache(10);
+  cache.Put("a", 1, "value");
+
+  EXPECT_EQ(nullptr, cache.Get("a", 2));
+  EXPECT_EQ(0u, cache.size());
+
+  // Not resurrected by looking it up with the old generation again
+  EXPECT_EQ(nullptr, cache.Get("a", 1));
+}
+
+TEST(AdBlockEngineGenerationCacheTest, PutReplacesValueFromOtherGeneration) {
+  AdBlockEngineGenerationCache<std::string> cache(10);
+  cache.Put("a", 1, "old");
+  cache.Put("a", 2, "new");
+
+  EXPECT_EQ(1u, cache.size());
+  const std::string* value = cache.Get("a", 2);
+  ASSERT_NE(nullptr, value);
+  EXPECT_EQ("new", *value);
+}
+
+TEST(AdBlockEngineGenerationCacheTest, EvictsLeastRecentlyUsed) {
+  AdBlockEngineGenerationCache<std::string> cache(2);
+
+  cache.Put("a", 1, "a");
+  cache.Put("b", 1, "b");
+  EXPECT_NE(nullptr, cache.Get("a", 1));
+  cache.Put("c", 1, "c");
+
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_NE(nullptr, cache.Get("a", 1));
+  EXPECT_EQ(nullptr, cache.Get("b", 1));
+  EXPECT_NE(nullptr, cache.Get("c", 1));
+}
+
+}  // namespace brave_shields
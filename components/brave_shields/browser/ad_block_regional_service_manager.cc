@@ -187,6 +187,7 @@ void AdBlockRegionalServiceManager::EnableFilterList(
       DCHECK(it != regional_services_.end());
       it->second->Unregister();
       regional_services_.erase(it);
+      AdBlockBaseService::IncrementEngineGeneration();
     }
   }
 
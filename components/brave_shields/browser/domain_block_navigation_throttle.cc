@@ -10,9 +10,11 @@
 
 #include "base/bind.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/no_destructor.h"
 #include "base/task/post_task.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
+#include "brave/components/brave_shields/browser/ad_block_engine_generation_cache.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/domain_block_controller_client.h"
@@ -32,6 +34,19 @@
 
 namespace {
 
+constexpr size_t kMaxCachedVerdicts = 100;
+
+using DomainBlockVerdictCache =
+    brave_shields::AdBlockEngineGenerationCache<bool>;
+
+// Whether recently navigated URLs should be blocked, kept per URL since rules
+// may only match some paths of a host. Only used on the UI thread, and only
+// for regular profiles.
+DomainBlockVerdictCache* GetDomainBlockVerdictCache() {
+  static base::NoDestructor<DomainBlockVerdictCache> cache(kMaxCachedVerdicts);
+  return cache.get();
+}
+
 bool ShouldBlockDomainOnTaskRunner(
     brave_shields::AdBlockService* ad_block_service,
     const GURL& url) {
@@ -111,14 +126,29 @@ DomainBlockNavigationThrottle::WillStartRequest() {
   if (tab_storage->IsProceeding())
     return content::NavigationThrottle::PROCEED;
 
+  // Navigations to recently allowed URLs don't need to wait behind the
+  // subresource checks on the ad block task runner. Blocking still has to
+  // defer the navigation to show the interstitial, so it is checked again.
+  // Off-the-record (including Tor) navigations are never remembered.
+  const uint64_t engine_generation = AdBlockBaseService::GetEngineGeneration();
+  if (!web_contents->GetBrowserContext()->IsOffTheRecord()) {
+    const bool* cached_should_block =
+        GetDomainBlockVerdictCache()->Get(request_url.spec(),
+                                          engine_generation);
+    if (cached_should_block && !*cached_should_block)
+      return content::NavigationThrottle::PROCEED;
+  }
+
   // Otherwise, call the ad block service on a task runner to determine whether
   // this domain should be blocked.
+  defer_start_time_ = base::TimeTicks::Now();
   ad_block_service_->GetTaskRunner()->PostTaskAndReplyWithResult(
       FROM_HERE,
       base::BindOnce(&ShouldBlockDomainOnTaskRunner, ad_block_service_,
                      request_url),
       base::BindOnce(&DomainBlockNavigationThrottle::OnShouldBlockDomain,
-                     weak_ptr_factory_.GetWeakPtr()));
+                     weak_ptr_factory_.GetWeakPtr(), request_url,
+                     engine_generation));
 
   // Since the call to the ad block service is asynchronous, we defer the final
   // decision of whether to allow or block this navigation. The callback from
@@ -132,7 +162,21 @@ DomainBlockNavigationThrottle::WillRedirectRequest() {
 }
 
 void DomainBlockNavigationThrottle::OnShouldBlockDomain(
+    const GURL& request_url,
+    uint64_t engine_generation,
     bool should_block_domain) {
+  UMA_HISTOGRAM_TIMES("Brave.DomainBlock.NavigationDelay",
+                      base::TimeTicks::Now() - defer_start_time_);
+
+  // If an engine changed while we were waiting, the generation no longer
+  // matches and the verdict is ignored by the next lookup.
+  content::BrowserContext* context =
+      navigation_handle()->GetWebContents()->GetBrowserContext();
+  if (!context->IsOffTheRecord()) {
+    GetDomainBlockVerdictCache()->Put(request_url.spec(), engine_generation,
+                                      should_block_domain);
+  }
+
   if (should_block_domain) {
     ShowInterstitial();
   } else {
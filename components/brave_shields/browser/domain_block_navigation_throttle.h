@@ -6,11 +6,14 @@
 #ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_DOMAIN_BLOCK_NAVIGATION_THROTTLE_H_
 #define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_DOMAIN_BLOCK_NAVIGATION_THROTTLE_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "content/public/browser/navigation_throttle.h"
 #include "url/gurl.h"
 
@@ -54,13 +57,16 @@ class DomainBlockNavigationThrottle : public content::NavigationThrottle {
   const char* GetNameForLogging() override;
 
  private:
-  void OnShouldBlockDomain(bool should_block_domain);
+  void OnShouldBlockDomain(const GURL& request_url,
+                           uint64_t engine_generation,
+                           bool should_block_domain);
   void ShowInterstitial();
 
   AdBlockService* ad_block_service_ = nullptr;
   AdBlockCustomFiltersService* ad_block_custom_filters_service_ = nullptr;
   HostContentSettingsMap* content_settings_ = nullptr;
   std::string locale_;
+  base::TimeTicks defer_start_time_;
   base::WeakPtrFactory<DomainBlockNavigationThrottle> weak_ptr_factory_{this};
 };
 
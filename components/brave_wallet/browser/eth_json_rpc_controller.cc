@@ -5,9 +5,16 @@
 
 #include "brave/components/brave_wallet/browser/eth_json_rpc_controller.h"
 
+#include <tuple>
 #include <utility>
 
+#include "base/bind.h"
 #include "base/environment.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/notreached.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "base/values.h"
 #include "brave/components/brave_wallet/browser/eth_call_data_builder.h"
 #include "brave/components/brave_wallet/browser/eth_requests.h"
 #include "brave/components/brave_wallet/browser/eth_response_parser.h"
@@ -44,6 +51,52 @@ net::NetworkTrafficAnnotationTag GetNetworkTrafficAnnotationTag() {
 
 const unsigned int kRetriesCountOnNetworkChange = 1;
 
+// Read-only calls issued within this window are sent in a single batch.
+constexpr base::TimeDelta kReadOnlyBatchWindow =
+    base::TimeDelta::FromMilliseconds(10);
+constexpr size_t kMaxReadOnlyBatchSize = 100;
+// Roughly one block time on mainnet, so cached results are at most about
+// one block stale.
+constexpr base::TimeDelta kReadOnlyResponseTTL =
+    base::TimeDelta::FromSeconds(12);
+constexpr size_t kMaxCachedResponses = 256;
+
+bool IsSuccessStatus(int status) {
+  return status >= 200 && status <= 299;
+}
+
+// JSON-RPC errors come back with a 2xx status too, so only bodies carrying
+// a result are worth caching.
+bool HasJsonRpcResult(const std::string& body) {
+  base::Optional<base::Value> response = base::JSONReader::Read(body);
+  return response && response->is_dict() && response->FindKey("result");
+}
+
+// Error returned for a call which has no response in a batch response.
+std::string GetMissingBatchResponseError(int id) {
+  base::Value error(base::Value::Type::DICTIONARY);
+  error.SetIntKey("code", -32603);
+  error.SetStringKey("message", "Missing from batch response");
+  base::Value response(base::Value::Type::DICTIONARY);
+  response.SetStringKey("jsonrpc", "2.0");
+  response.SetIntKey("id", id);
+  response.SetKey("error", std::move(error));
+  std::string body;
+  base::JSONWriter::Write(response, &body);
+  return body;
+}
+
+bool IsTransactionSubmission(const std::string& json_payload) {
+  if (json_payload.find("eth_send") == std::string::npos)
+    return false;
+  base::Optional<base::Value> call = base::JSONReader::Read(json_payload);
+  if (!call || !call->is_dict())
+    return false;
+  const std::string* method = call->FindStringKey("method");
+  return method && (*method == "eth_sendTransaction" ||
+                    *method == "eth_sendRawTransaction");
+}
+
 std::string GetInfuraProjectID() {
   std::string project_id(BRAVE_INFURA_PROJECT_ID);
   std::unique_ptr<base::Environment> env(base::Environment::Create());
@@ -73,9 +126,39 @@ EthJsonRpcController::EthJsonRpcController(content::BrowserContext* context,
 
 EthJsonRpcController::~EthJsonRpcController() {}
 
+EthJsonRpcController::CachedResponse::CachedResponse() = default;
+EthJsonRpcController::CachedResponse::CachedResponse(CachedResponse&&) =
+    default;
+EthJsonRpcController::CachedResponse&
+EthJsonRpcController::CachedResponse::operator=(CachedResponse&&) = default;
+EthJsonRpcController::CachedResponse::~CachedResponse() = default;
+
+EthJsonRpcController::ReadOnlyRequestKey::ReadOnlyRequestKey(
+    uint64_t generation,
+    const GURL& network_url,
+    const std::string& json_payload)
+    : generation(generation),
+      network_url(network_url),
+      json_payload(json_payload) {}
+EthJsonRpcController::ReadOnlyRequestKey::ReadOnlyRequestKey(
+    const ReadOnlyRequestKey&) = default;
+EthJsonRpcController::ReadOnlyRequestKey::~ReadOnlyRequestKey() = default;
+
+bool EthJsonRpcController::ReadOnlyRequestKey::operator<(
+    const ReadOnlyRequestKey& other) const {
+  return std::tie(generation, network_url, json_payload) <
+         std::tie(other.generation, other.network_url, other.json_payload);
+}
+
 void EthJsonRpcController::Request(const std::string& json_payload,
                                    URLRequestCallback callback,
                                    bool auto_retry_on_network_change) {
+  // A transaction changes the balance and nonce of its sender, and possibly
+  // token balances. The sender of a raw transaction is only known once its
+  // signature is recovered, so all cached responses are dropped.
+  if (IsTransactionSubmission(json_payload))
+    InvalidateReadOnlyResponses();
+
   auto request = std::make_unique<network::ResourceRequest>();
   request->url = network_url_;
   request->load_flags = net::LOAD_BYPASS_CACHE | net::LOAD_DISABLE_CACHE;
@@ -131,6 +214,182 @@ void EthJsonRpcController::OnURLLoaderComplete(
                           headers);
 }
 
+void EthJsonRpcController::RequestReadOnly(const std::string& json_payload,
+                                           URLRequestCallback callback) {
+  ReadOnlyRequestKey key(read_only_generation_, network_url_, json_payload);
+
+  auto cached = response_cache_.find(key);
+  if (cached != response_cache_.end()) {
+    if (cached->second.expiration_time > base::TimeTicks::Now()) {
+      base::SequencedTaskRunnerHandle::Get()->PostTask(
+          FROM_HERE,
+          base::BindOnce(&EthJsonRpcController::RunCachedResponse,
+                         weak_ptr_factory_.GetWeakPtr(), std::move(callback),
+                         cached->second.status, cached->second.body,
+                         cached->second.headers));
+      return;
+    }
+    response_cache_.erase(cached);
+  }
+
+  auto pending = pending_callbacks_.find(key);
+  if (pending != pending_callbacks_.end()) {
+    // Identical call is already queued or in flight.
+    pending->second.push_back(std::move(callback));
+    return;
+  }
+  pending_callbacks_[key].push_back(std::move(callback));
+
+  queued_payloads_.push_back(json_payload);
+  if (queued_payloads_.size() >= kMaxReadOnlyBatchSize) {
+    batch_timer_.Stop();
+    FlushQueuedReadOnlyRequests();
+    return;
+  }
+  if (!batch_timer_.IsRunning()) {
+    batch_timer_.Start(
+        FROM_HERE, kReadOnlyBatchWindow,
+        base::BindOnce(&EthJsonRpcController::FlushQueuedReadOnlyRequests,
+                       base::Unretained(this)));
+  }
+}
+
+void EthJsonRpcController::RunCachedResponse(
+    URLRequestCallback callback,
+    const int status,
+    const std::string& body,
+    const std::map<std::string, std::string>& headers) {
+  std::move(callback).Run(status, body, headers);
+}
+
+void EthJsonRpcController::FlushQueuedReadOnlyRequests() {
+  std::vector<std::string> payloads;
+  payloads.swap(queued_payloads_);
+  if (payloads.empty())
+    return;
+
+  if (payloads.size() == 1) {
+    ReadOnlyRequestKey key(read_only_generation_, network_url_,
+                           payloads.front());
+    Request(payloads.front(),
+            base::BindOnce(&EthJsonRpcController::OnReadOnlyResponse,
+                           base::Unretained(this), std::move(key)),
+            true);
+    return;
+  }
+
+  // Each call gets its index as id so responses can be matched back, as
+  // servers are free to answer a batch in any order.
+  base::Value batch(base::Value::Type::LIST);
+  for (size_t i = 0; i < payloads.size(); ++i) {
+    base::Optional<base::Value> call = base::JSONReader::Read(payloads[i]);
+    if (!call || !call->is_dict()) {
+      NOTREACHED() << "Invalid JSON-RPC payload: " << payloads[i];
+      call = base::Value(base::Value::Type::DICTIONARY);
+    }
+    call->SetIntKey("id", static_cast<int>(i));
+    batch.Append(std::move(*call));
+  }
+  std::string batch_payload;
+  base::JSONWriter::Write(batch, &batch_payload);
+
+  Request(batch_payload,
+          base::BindOnce(&EthJsonRpcController::OnReadOnlyBatchResponse,
+                         base::Unretained(this), read_only_generation_,
+                         network_url_, std::move(payloads)),
+          true);
+}
+
+void EthJsonRpcController::OnReadOnlyBatchResponse(
+    uint64_t generation,
+    const GURL& network_url,
+    const std::vector<std::string>& payloads,
+    const int status,
+    const std::string& body,
+    const std::map<std::string, std::string>& headers) {
+  base::Optional<base::Value> responses;
+  if (IsSuccessStatus(status))
+    responses = base::JSONReader::Read(body);
+  if (!responses || !responses->is_list()) {
+    // The batch as a whole failed, e.g. with an HTTP error or a single
+    // JSON-RPC error, so every call gets that failure.
+    for (const auto& payload : payloads) {
+      OnReadOnlyResponse(ReadOnlyRequestKey(generation, network_url, payload),
+                         status, body, headers);
+    }
+    return;
+  }
+
+  std::vector<std::string> bodies(payloads.size());
+  for (const auto& response : responses->GetList()) {
+    if (!response.is_dict())
+      continue;
+    base::Optional<int> id = response.FindIntKey("id");
+    if (!id || *id < 0 || static_cast<size_t>(*id) >= payloads.size())
+      continue;
+    base::JSONWriter::Write(response, &bodies[*id]);
+  }
+
+  for (size_t i = 0; i < payloads.size(); ++i) {
+    if (bodies[i].empty())
+      bodies[i] = GetMissingBatchResponseError(static_cast<int>(i));
+    OnReadOnlyResponse(ReadOnlyRequestKey(generation, network_url, payloads[i]),
+                       status, bodies[i], headers);
+  }
+}
+
+void EthJsonRpcController::OnReadOnlyResponse(
+    const ReadOnlyRequestKey& key,
+    const int status,
+    const std::string& body,
+    const std::map<std::string, std::string>& headers) {
+  auto pending = pending_callbacks_.find(key);
+  if (pending == pending_callbacks_.end())
+    return;
+  std::vector<URLRequestCallback> callbacks = std::move(pending->second);
+  pending_callbacks_.erase(pending);
+
+  if (IsSuccessStatus(status) && HasJsonRpcResult(body))
+    CacheReadOnlyResponse(key, status, body, headers);
+
+  for (auto& callback : callbacks)
+    std::move(callback).Run(status, body, headers);
+}
+
+void EthJsonRpcController::CacheReadOnlyResponse(
+    const ReadOnlyRequestKey& key,
+    const int status,
+    const std::string& body,
+    const std::map<std::string, std::string>& headers) {
+  // Responses from a network which is no longer selected, or to calls made
+  // before the cache was invalidated, are not reused.
+  if (key.network_url != network_url_ ||
+      key.generation != read_only_generation_)
+    return;
+
+  const base::TimeTicks now = base::TimeTicks::Now();
+  if (response_cache_.size() >= kMaxCachedResponses) {
+    auto oldest = response_cache_.begin();
+    for (auto it = response_cache_.begin(); it != response_cache_.end();) {
+      if (it->second.expiration_time <= now) {
+        it = response_cache_.erase(it);
+        continue;
+      }
+      if (it->second.expiration_time < oldest->second.expiration_time)
+        oldest = it;
+      ++it;
+    }
+    if (response_cache_.size() >= kMaxCachedResponses)
+      response_cache_.erase(oldest);
+  }
+
+  CachedResponse& cached = response_cache_[key];
+  cached.status = status;
+  cached.body = body;
+  cached.headers = headers;
+  cached.expiration_time = now + kReadOnlyResponseTTL;
+}
+
 Network EthJsonRpcController::GetNetwork() const {
   return network_;
 }
@@ -140,6 +399,7 @@ GURL EthJsonRpcController::GetNetworkURL() const {
 }
 
 void EthJsonRpcController::SetNetwork(Network network) {
+  InvalidateReadOnlyResponses();
   std::string subdomain;
   network_ = network;
   switch (network) {
@@ -174,18 +434,28 @@ void EthJsonRpcController::SetNetwork(Network network) {
 }
 
 void EthJsonRpcController::SetCustomNetwork(const GURL& network_url) {
+  InvalidateReadOnlyResponses();
   network_ = Network::kCustom;
   network_url_ = network_url;
 }
 
+void EthJsonRpcController::InvalidateReadOnlyResponses() {
+  // Queued calls were made against the current network and state, so they
+  // are sent before |network_url_| is updated or a transaction goes out.
+  batch_timer_.Stop();
+  FlushQueuedReadOnlyRequests();
+  ++read_only_generation_;
+  response_cache_.clear();
+}
+
 void EthJsonRpcController::GetBalance(
     const std::string& address,
     EthJsonRpcController::GetBallanceCallback callback) {
   auto internal_callback =
       base::BindOnce(&EthJsonRpcController::OnGetBalance,
-                     base::Unretained(this), std::move(callback));
-  return Request(eth_getBalance(address, "latest"),
-                 std::move(internal_callback), true);
+                     weak_ptr_factory_.GetWeakPtr(), std::move(callback));
+  return RequestReadOnly(eth_getBalance(address, "latest"),
+                         std::move(internal_callback));
 }
 
 void EthJsonRpcController::OnGetBalance(
@@ -212,13 +482,13 @@ bool EthJsonRpcController::GetERC20TokenBalance(
     EthJsonRpcController::GetBallanceCallback callback) {
   auto internal_callback =
       base::BindOnce(&EthJsonRpcController::OnGetERC20TokenBalance,
-                     base::Unretained(this), std::move(callback));
+                     weak_ptr_factory_.GetWeakPtr(), std::move(callback));
   std::string data;
   if (!erc20::BalanceOf(address, &data)) {
     return false;
   }
-  Request(eth_call("", address, "", "", "", data, ""),
-          std::move(internal_callback), true);
+  RequestReadOnly(eth_call("", address, "", "", "", data, ""),
+                  std::move(internal_callback));
   return true;
 }
 
@@ -246,14 +516,14 @@ bool EthJsonRpcController::UnstoppableDomainsProxyReaderGetMany(
     UnstoppableDomainsProxyReaderGetManyCallback callback) {
   auto internal_callback = base::BindOnce(
       &EthJsonRpcController::OnUnstoppableDomainsProxyReaderGetMany,
-      base::Unretained(this), std::move(callback));
+      weak_ptr_factory_.GetWeakPtr(), std::move(callback));
   std::string data;
   if (!unstoppable_domains::GetMany(keys, domain, &data)) {
     return false;
   }
 
-  Request(eth_call("", contract_address, "", "", "", data, "latest"),
-          std::move(internal_callback), true);
+  RequestReadOnly(eth_call("", contract_address, "", "", "", data, "latest"),
+                  std::move(internal_callback));
   return true;
 }
 
@@ -13,6 +13,9 @@
 #include <vector>
 
 #include "base/callback.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "brave/components/brave_wallet/browser/brave_wallet_constants.h"
 #include "url/gurl.h"
 
@@ -35,9 +38,17 @@ class EthJsonRpcController {
       base::OnceCallback<void(const int,
                               const std::string&,
                               const std::map<std::string, std::string>&)>;
+  // Sends |json_payload| as is in its own POST request.
   void Request(const std::string& json_payload,
                URLRequestCallback callback,
                bool auto_retry_on_network_change);
+  // Same as Request but for read-only calls issued by the wallet itself.
+  // Calls made within a short window are sent together as one JSON-RPC 2.0
+  // batch, identical calls in flight share a single request, and successful
+  // responses are reused for about one block time, or until a transaction is
+  // submitted through Request.
+  void RequestReadOnly(const std::string& json_payload,
+                       URLRequestCallback callback);
   using GetBallanceCallback =
       base::OnceCallback<void(bool status, const std::string& balance)>;
   void GetBalance(const std::string& address, GetBallanceCallback callback);
@@ -69,9 +80,57 @@ class EthJsonRpcController {
  private:
   using SimpleURLLoaderList =
       std::list<std::unique_ptr<network::SimpleURLLoader>>;
+  struct ReadOnlyRequestKey {
+    ReadOnlyRequestKey(uint64_t generation,
+                       const GURL& network_url,
+                       const std::string& json_payload);
+    ReadOnlyRequestKey(const ReadOnlyRequestKey&);
+    ~ReadOnlyRequestKey();
+
+    bool operator<(const ReadOnlyRequestKey& other) const;
+
+    // |read_only_generation_| when the call was made.
+    uint64_t generation;
+    GURL network_url;
+    std::string json_payload;
+  };
+  struct CachedResponse {
+    CachedResponse();
+    CachedResponse(CachedResponse&&);
+    CachedResponse& operator=(CachedResponse&&);
+    ~CachedResponse();
+
+    int status = 0;
+    std::string body;
+    std::map<std::string, std::string> headers;
+    base::TimeTicks expiration_time;
+  };
+
   void OnURLLoaderComplete(SimpleURLLoaderList::iterator iter,
                            URLRequestCallback callback,
                            const std::unique_ptr<std::string> response_body);
+  void InvalidateReadOnlyResponses();
+  void FlushQueuedReadOnlyRequests();
+  void RunCachedResponse(URLRequestCallback callback,
+                         const int status,
+                         const std::string& body,
+                         const std::map<std::string, std::string>& headers);
+  void OnReadOnlyBatchResponse(
+      uint64_t generation,
+      const GURL& network_url,
+      const std::vector<std::string>& payloads,
+      const int status,
+      const std::string& body,
+      const std::map<std::string, std::string>& headers);
+  void OnReadOnlyResponse(const ReadOnlyRequestKey& key,
+                          const int status,
+                          const std::string& body,
+                          const std::map<std::string, std::string>& headers);
+  void CacheReadOnlyResponse(const ReadOnlyRequestKey& key,
+                             const int status,
+                             const std::string& body,
+                             const std::map<std::string, std::string>& headers);
+
   void OnGetBalance(GetBallanceCallback callback,
                     const int status,
                     const std::string& body,
@@ -92,6 +151,19 @@ class EthJsonRpcController {
   GURL network_url_;
   SimpleURLLoaderList url_loaders_;
   Network network_;
+
+  // Payloads waiting for |batch_timer_| to be sent to |network_url_|.
+  std::vector<std::string> queued_payloads_;
+  base::OneShotTimer batch_timer_;
+  // Callbacks of queued and in-flight read-only requests.
+  std::map<ReadOnlyRequestKey, std::vector<URLRequestCallback>>
+      pending_callbacks_;
+  std::map<ReadOnlyRequestKey, CachedResponse> response_cache_;
+  // Bumped whenever cached responses may have become stale, so that
+  // responses to calls made before aren't cached or shared with later calls.
+  uint64_t read_only_generation_ = 0;
+
+  base::WeakPtrFactory<EthJsonRpcController> weak_ptr_factory_{this};
 };
 
 }  // namespace brave_wallet
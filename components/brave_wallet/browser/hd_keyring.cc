@@ -5,6 +5,8 @@
 
 #include "brave/components/brave_wallet/browser/hd_keyring.h"
 
+#include <utility>
+
 #include "base/strings/string_number_conversions.h"
 #include "brave/components/brave_wallet/browser/brave_wallet_utils.h"
 #include "brave/components/brave_wallet/browser/eth_address.h"
@@ -33,32 +35,35 @@ void HDKeyring::AddAccounts(size_t number) {
   size_t cur_accounts_number = accounts_.size();
   for (size_t i = cur_accounts_number; i < cur_accounts_number + number; ++i) {
     if (root_) {
-      accounts_.push_back(root_->DeriveChild(i));
+      AddAccount(root_->DeriveChild(i));
     }
   }
 }
 
 std::vector<std::string> HDKeyring::GetAccounts() {
-  std::vector<std::string> addresses;
-  for (size_t i = 0; i < accounts_.size(); ++i) {
-    addresses.push_back(GetAddress(i));
-  }
-  return addresses;
+  return addresses_;
 }
 
 void HDKeyring::RemoveAccount(const std::string& address) {
-  for (size_t i = 0; i < accounts_.size(); ++i) {
-    if (GetAddress(i) == address) {
-      accounts_.erase(accounts_.begin() + i);
+  if (!address_to_key_.erase(address))
+    return;
+  // Removes every account with |address|, not only the indexed one.
+  for (size_t i = accounts_.size(); i > 0; --i) {
+    if (addresses_[i - 1] == address) {
+      accounts_.erase(accounts_.begin() + i - 1);
+      addresses_.erase(addresses_.begin() + i - 1);
     }
   }
 }
 
 std::string HDKeyring::GetAddress(size_t index) {
-  if (accounts_.empty() || index >= accounts_.size())
+  if (index >= addresses_.size())
     return std::string();
-  const std::vector<uint8_t> public_key =
-      accounts_[index]->GetUncompressedPublicKey();
+  return addresses_[index];
+}
+
+std::string HDKeyring::GetAddressInternal(const HDKey& hd_key) const {
+  const std::vector<uint8_t> public_key = hd_key.GetUncompressedPublicKey();
   // trim the header byte 0x04
   const std::vector<uint8_t> pubkey_no_header(public_key.begin() + 1,
                                               public_key.end());
@@ -99,11 +104,18 @@ std::vector<uint8_t> HDKeyring::SignMessage(
 }
 
 HDKey* HDKeyring::GetHDKeyFromAddress(const std::string& address) {
-  for (size_t i = 0; i < accounts_.size(); ++i) {
-    if (GetAddress(i) == address)
-      return accounts_[i].get();
-  }
-  return nullptr;
+  auto it = address_to_key_.find(address);
+  if (it == address_to_key_.end())
+    return nullptr;
+  return it->second;
+}
+
+void HDKeyring::AddAccount(std::unique_ptr<HDKey> hd_key) {
+  addresses_.push_back(hd_key ? GetAddressInternal(*hd_key) : std::string());
+  // The first account wins for duplicated addresses.
+  if (hd_key)
+    address_to_key_.emplace(addresses_.back(), hd_key.get());
+  accounts_.push_back(std::move(hd_key));
 }
 
 }  // namespace brave_wallet
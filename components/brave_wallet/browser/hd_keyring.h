@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 
+#include "base/containers/flat_map.h"
 #include "base/gtest_prod_util.h"
 
 namespace brave_wallet {
@@ -20,6 +21,7 @@ class EthTransaction;
 
 FORWARD_DECLARE_TEST(HDKeyringUnitTest, ConstructRootHDKey);
 FORWARD_DECLARE_TEST(HDKeyringUnitTest, SignMessage);
+FORWARD_DECLARE_TEST(HDKeyringUnitTest, LargeKeyring);
 class HDKeyring {
  public:
   enum Type { kDefault = 0, kLedger, kTrezor, kBitcoin };
@@ -36,8 +38,9 @@ class HDKeyring {
   virtual std::vector<std::string> GetAccounts();
   virtual void RemoveAccount(const std::string& address);
 
-  // Bitcoin keyring can override this for different address calculation
-  virtual std::string GetAddress(size_t index);
+  // Returns the cached address of the account at |index|, empty string if
+  // |index| is out of range.
+  std::string GetAddress(size_t index);
 
   // TODO(darkdh): Abstract Transacation class
   // eth_signTransaction
@@ -49,13 +52,25 @@ class HDKeyring {
  protected:
   HDKey* GetHDKeyFromAddress(const std::string& address);
 
+  // Bitcoin keyring can override this for different address calculation
+  virtual std::string GetAddressInternal(const HDKey& hd_key) const;
+
+  // Appends |hd_key| to the accounts and indexes its address.
+  void AddAccount(std::unique_ptr<HDKey> hd_key);
+
   std::unique_ptr<HDKey> root_;
   std::unique_ptr<HDKey> master_key_;
-  std::vector<std::unique_ptr<HDKey>> accounts_;
 
  private:
+  // Only modified through AddAccount and RemoveAccount, which keep
+  // |addresses_| parallel to it and |address_to_key_| up to date.
+  std::vector<std::unique_ptr<HDKey>> accounts_;
+  std::vector<std::string> addresses_;
+  base::flat_map<std::string, HDKey*> address_to_key_;
+
   FRIEND_TEST_ALL_PREFIXES(HDKeyringUnitTest, ConstructRootHDKey);
   FRIEND_TEST_ALL_PREFIXES(HDKeyringUnitTest, SignMessage);
+  FRIEND_TEST_ALL_PREFIXES(HDKeyringUnitTest, LargeKeyring);
 
   HDKeyring(const HDKeyring&) = delete;
   HDKeyring& operator=(const HDKeyring&) = delete;
@@ -7,8 +7,10 @@
 
 #include <utility>
 
+#include "base/logging.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
+#include "base/timer/elapsed_timer.h"
 #include "brave/components/brave_wallet/browser/eth_transaction.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -73,6 +75,68 @@ TEST(HDKeyringUnitTest, Accounts) {
   EXPECT_TRUE(keyring2.GetAddress(0).empty());
 }
 
+TEST(HDKeyringUnitTest, LargeKeyring) {
+  HDKeyring keyring;
+  std::vector<uint8_t> seed;
+  EXPECT_TRUE(base::HexStringToBytes(
+      "13ca6c28d26812f82db27908de0b0b7b18940cc4e9d96ebd7de190f706741489907ef65b"
+      "8f9e36c31dc46e81472b6a5e40a4487e725ace445b8203f243fb8958",
+      &seed));
+  keyring.ConstructRootHDKey(seed, "m/44'/60'/0'/0");
+
+  const size_t kAccountsNumber = 1000;
+  base::ElapsedTimer add_timer;
+  keyring.AddAccounts(kAccountsNumber - 1);
+  // Accounts added after the first batch are indexed as well.
+  keyring.AddAccounts();
+  VLOG(1) << "AddAccounts(" << kAccountsNumber
+          << "): " << add_timer.Elapsed().InMilliseconds() << "ms";
+
+  base::ElapsedTimer get_accounts_timer;
+  std::vector<std::string> accounts = keyring.GetAccounts();
+  VLOG(1) << "GetAccounts: "
+          << get_accounts_timer.Elapsed().InMicroseconds() << "us";
+  ASSERT_EQ(accounts.size(), kAccountsNumber);
+  EXPECT_EQ(accounts[0], "0x2166fB4e11D44100112B1124ac593081519cA1ec");
+  EXPECT_EQ(accounts[1], "0x2A22ad45446E8b34Da4da1f4ADd7B1571Ab4e4E7");
+  EXPECT_EQ(accounts[2], "0x02e77f0e2fa06F95BDEa79Fad158477723145838");
+
+  base::ElapsedTimer lookup_timer;
+  for (size_t i = 0; i < accounts.size(); ++i) {
+    EXPECT_EQ(keyring.GetHDKeyFromAddress(accounts[i]),
+              keyring.accounts_[i].get());
+  }
+  VLOG(1) << "GetHDKeyFromAddress x" << kAccountsNumber << ": "
+          << lookup_timer.Elapsed().InMicroseconds() << "us";
+  EXPECT_EQ(
+      keyring.GetHDKeyFromAddress("0xDEADBEEFdeadbeefdeadbeefdeadbeefDEADBEEF"),
+      nullptr);
+
+  // Removal keeps the index consistent with the account list.
+  keyring.RemoveAccount(accounts[500]);
+  EXPECT_EQ(keyring.GetHDKeyFromAddress(accounts[500]), nullptr);
+  EXPECT_EQ(keyring.GetAddress(500), accounts[501]);
+  EXPECT_EQ(keyring.GetHDKeyFromAddress(accounts[501]),
+            keyring.accounts_[500].get());
+  EXPECT_EQ(keyring.GetAccounts().size(), kAccountsNumber - 1);
+  EXPECT_EQ(keyring.GetAddress(998), accounts[999]);
+
+  // Every account with a removed address goes away.
+  std::unique_ptr<HDKey> key = std::make_unique<HDKey>();
+  key->SetPrivateKey(std::vector<uint8_t>(32, 0x1));
+  std::unique_ptr<HDKey> same_key = std::make_unique<HDKey>();
+  same_key->SetPrivateKey(std::vector<uint8_t>(32, 0x1));
+  HDKey* first_key = key.get();
+  keyring.AddAccount(std::move(key));
+  keyring.AddAccount(std::move(same_key));
+  const std::string address = keyring.GetAddress(999);
+  EXPECT_EQ(keyring.GetAddress(1000), address);
+  EXPECT_EQ(keyring.GetHDKeyFromAddress(address), first_key);
+  keyring.RemoveAccount(address);
+  EXPECT_EQ(keyring.GetHDKeyFromAddress(address), nullptr);
+  EXPECT_EQ(keyring.GetAccounts().size(), kAccountsNumber - 1);
+}
+
 TEST(HDKeyringUnitTest, SignTransaction) {
   // Specific signature check is in eth_transaction_unittest.cc
   HDKeyring keyring;
@@ -104,7 +168,7 @@ TEST(HDKeyringUnitTest, SignMessage) {
   key->SetPrivateKey(private_key);
 
   HDKeyring keyring;
-  keyring.accounts_.push_back(std::move(key));
+  keyring.AddAccount(std::move(key));
   EXPECT_EQ(keyring.GetAddress(0),
             "0xbE93f9BacBcFFC8ee6663f2647917ed7A20a57BB");
 
@@ -6,16 +6,42 @@
 #ifndef BRAVE_COMPONENTS_BRAVE_WALLET_BROWSER_RLP_DECODE_H_
 #define BRAVE_COMPONENTS_BRAVE_WALLET_BROWSER_RLP_DECODE_H_
 
+#include <stdint.h>
+
 #include <string>
+#include <vector>
 
+#include "base/containers/span.h"
 #include "base/values.h"
 
 namespace brave_wallet {
 
+// A decoded RLP item which refers to the input it was decoded from instead of
+// copying it. |data| holds the bytes of a string, or the encoded payload of a
+// list whose decoded items are in |items|.
+struct RLPItem {
+  RLPItem();
+  RLPItem(RLPItem&& other);
+  RLPItem& operator=(RLPItem&& other);
+  ~RLPItem();
+
+  bool is_list = false;
+  base::span<const uint8_t> data;
+  std::vector<RLPItem> items;
+};
+
 // Recursive Length Prefix (RLP) decoding of arbitrarily nested arrays of data
 // Input string should be a hex string but without the 0x prefix
 bool RLPDecode(const std::string& s, base::Value* output);
 
+// Decodes |input| without copying it, so |input| must outlive |output|. Only
+// the first item of |input| is decoded, as with the base::Value variant.
+bool RLPDecode(base::span<const uint8_t> input, RLPItem* output);
+
+// Converts |item| into the base::Value which RLPDecode decodes it to, with
+// strings as string values and lists as list values
+base::Value RLPItemToValue(const RLPItem& item);
+
 }  // namespace brave_wallet
 
 #endif  // BRAVE_COMPONENTS_BRAVE_WALLET_BROWSER_RLP_DECODE_H_
@@ -3,14 +3,280 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this file,
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include <random>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/strings/string_number_conversions.h"
+#include "base/timer/elapsed_timer.h"
 #include "brave/components/brave_wallet/browser/rlp_decode.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+// npm run test -- brave_unit_tests --filter=RLPDecodeTest.*
+
 namespace {
 
+// Decodes an integer
+bool LegacyRLPToInteger(const std::string& s, size_t* val) {
+  size_t length = s.length();
+  if (length == 0) {
+    return false;
+  }
+
+  if (length == 1) {
+    *val = static_cast<size_t>(static_cast<uint8_t>(s[0]));
+    return true;
+  }
+
+  size_t v2;
+  if (length <= 1 || !LegacyRLPToInteger(s.substr(0, length - 1), &v2)) {
+    return false;
+  }
+  *val = static_cast<size_t>(static_cast<uint8_t>(s[length - 1]) + v2 * 256);
+  return true;
+}
+
+bool LegacyIsWithinBounds(size_t offset, size_t data_len, size_t length) {
+  // This seems redundant but it is resistant to overflows
+  return offset <= length && data_len <= length && offset + data_len <= length;
+}
+
+// Decodes an offset, length, and value
+bool LegacyRLPDecodeLength(const std::string& s,
+                           size_t* offset,
+                           size_t* data_len,
+                           base::Value* value) {
+  size_t length = s.length();
+  if (length == 0) {
+    return false;
+  }
+  uint8_t prefix = static_cast<uint8_t>(s[0]);
+  if (prefix <= 0x7f) {
+    *offset = 0;
+    *data_len = 1;
+    std::string str = {s[0]};
+    *value = base::Value(str);
+    return true;
+  }
+
+  if (prefix <= 0xb7 && length > prefix - 0x80) {
+    size_t strLen = prefix - 0x80;
+    *offset = 1;
+    *data_len = strLen;
+    if (!LegacyIsWithinBounds(*offset, *data_len, length)) {
+      return false;
+    }
+    // If a string length is 1 it should have been handled by the single byte
+    // clause above.
+    if (*data_len == 1) {
+      return false;
+    }
+    std::string str = s.substr(*offset, *data_len);
+    *value = base::Value(str);
+    return true;
+  }
+
+  size_t i;
+  if (1 + prefix - 0xb7 <= length &&
+      LegacyRLPToInteger(s.substr(1, prefix - 0xb7), &i)) {
+    if (prefix <= 0xbf && length > prefix - 0xb7 &&
+        length > prefix - 0xb7 + i) {
+      size_t strLen = i;
+      *offset = 1 + prefix - 0xb7;
+      *data_len = strLen;
+      if (!LegacyIsWithinBounds(*offset, *data_len, length)) {
+        return false;
+      }
+      // If a list contains 0-55 bytes, it should have been handled above by
+      // the RLP encoding spec.  So this input should never happen, even though
+      // it could in theory decode properly.
+      if (*data_len <= 55) {
+        return false;
+      }
+
+      std::string str = s.substr(*offset, *data_len);
+      *value = base::Value(str);
+      return true;
+    }
+  }
+
+  if (prefix <= 0xf7 && length > prefix - 0xc0) {
+    *offset = 1;
+    *data_len = prefix - 0xc0;
+    *value = base::ListValue();
+    return true;
+  }
+
+  // The data is a list if the range of the first byte is [0xf8, 0xff], and the
+  // total payload of the list whose length is equal to the first byte minus
+  // 0xf7 follows the first byte, and the concatenation of the RLP encodings
+  // of all items of the list follows the total payload of the list;
+  size_t list_data_len;
+  size_t list_len_length = prefix - 0xf7;
+  if (prefix <= 0xff && length >= 1 + prefix - 0xf7 &&
+      LegacyRLPToInteger(s.substr(1, list_len_length), &list_data_len)) {
+    // Skip past the prefix and the list len length
+    *offset = 1 + list_len_length;
+    *data_len = list_data_len;
+    // If a list contains 0-55 elements, it should have been handled above by
+    // the RLP encoding spec.  So this input should never happen, even though
+    // it could in theory decode properly.
+    if (*data_len <= 55 || !LegacyIsWithinBounds(*offset, *data_len, length)) {
+      return false;
+    }
+    *value = base::ListValue();
+    return true;
+  }
+
+  return false;
+}
+
+// Decodes a string and gives the result, an offset, and a data_len
+bool LegacyRLPDecodeInternal(const std::string& s,
+                             base::Value* output,
+                             size_t* offset,
+                             size_t* data_len) {
+  size_t length = s.length();
+  if (!LegacyRLPDecodeLength(s, offset, data_len, output)) {
+    return false;
+  }
+
+  if (output->is_string()) {
+    if (!LegacyIsWithinBounds(*offset, *data_len, length)) {
+      return false;
+    }
+    std::string str = s.substr(*offset, *data_len);
+    *output = base::Value(str);
+  } else if (output->is_list()) {
+    *output = base::ListValue();
+    base::ListValue* output_list;
+    if (!output->GetAsList(&output_list)) {
+      return false;
+    }
+    if (!LegacyIsWithinBounds(*offset, *data_len, length)) {
+      return false;
+    }
+    std::string sub = s.substr(*offset, *data_len);
+    while (sub.length() > 0) {
+      base::Value v;
+      size_t offset2, data_len2;
+      if (!LegacyRLPDecodeInternal(sub, &v, &offset2, &data_len2)) {
+        return false;
+      }
+      output_list->Append(std::move(v));
+      *offset += data_len2 + offset2;
+      *data_len -= data_len2 + offset2;
+      if (!LegacyIsWithinBounds(*offset, *data_len, length)) {
+        return false;
+      }
+      sub = s.substr(*offset, *data_len);
+    }
+  }
+
+  return true;
+}
+
+// Decodes |s| the way RLPDecode did before it decoded views of the input,
+// copying the remainder of each list for every item
+bool LegacyRLPDecode(const std::string& s, base::Value* output) {
+  size_t offset;
+  size_t data_len;
+  bool result = LegacyRLPDecodeInternal(s, output, &offset, &data_len);
+  if (!result) {
+    *output = base::Value();
+  }
+  return result;
+}
+
+std::string RLPTestEncodeLength(size_t length, uint8_t offset) {
+  if (length < 56) {
+    return std::string(1, static_cast<char>(length + offset));
+  }
+  std::string length_bytes;
+  for (size_t i = length; i > 0; i /= 256) {
+    length_bytes.insert(length_bytes.begin(), static_cast<char>(i % 256));
+  }
+  return static_cast<char>(length_bytes.length() + offset + 55) +
+         length_bytes;
+}
+
+std::string RLPTestEncodeString(const std::string& s) {
+  if (s.length() == 1 && static_cast<uint8_t>(s[0]) < 0x80) {
+    return s;
+  }
+  return RLPTestEncodeLength(s.length(), 0x80) + s;
+}
+
+std::string RLPTestEncodeList(const std::string& payload) {
+  return RLPTestEncodeLength(payload.length(), 0xc0) + payload;
+}
+
+// Generates a random encoding of up to |max_depth| nested lists of strings
+std::string GenerateRLP(std::mt19937* generator, int max_depth) {
+  std::uniform_int_distribution<int> byte_distribution(0, 255);
+  if (max_depth == 0 || (*generator)() % 3 == 0) {
+    const size_t length =
+        (*generator)() % 4 == 0 ? 56 + (*generator)() % 200
+                                : (*generator)() % 56;
+    std::string s;
+    for (size_t i = 0; i < length; i++) {
+      s.push_back(static_cast<char>(byte_distribution(*generator)));
+    }
+    return RLPTestEncodeString(s);
+  }
+
+  std::string payload;
+  const int items = (*generator)() % 6;
+  for (int i = 0; i < items; i++) {
+    payload += GenerateRLP(generator, max_depth - 1);
+  }
+  return RLPTestEncodeList(payload);
+}
+
+// Corrupts |s| by replacing, removing or inserting random bytes
+void MutateRLP(std::mt19937* generator, int mutations, std::string* s) {
+  for (int i = 0; i < mutations && !s->empty(); i++) {
+    const size_t pos = (*generator)() % s->length();
+    const char byte = static_cast<char>((*generator)() % 256);
+    switch ((*generator)() % 3) {
+      case 0:
+        (*s)[pos] = byte;
+        break;
+      case 1:
+        s->erase(pos, 1);
+        break;
+      default:
+        s->insert(pos, 1, byte);
+        break;
+    }
+  }
+}
+
+// Returns the encoding of a signed legacy transaction, as sent to
+// eth_sendRawTransaction
+std::string GenerateSignedTransaction(std::mt19937* generator) {
+  auto random_bytes = [generator](size_t length) {
+    std::string bytes;
+    for (size_t i = 0; i < length; i++) {
+      bytes.push_back(static_cast<char>(1 + (*generator)() % 255));
+    }
+    return bytes;
+  };
+
+  const std::string payload =
+      RLPTestEncodeString(random_bytes(2)) +     // nonce
+      RLPTestEncodeString(random_bytes(5)) +     // gas price
+      RLPTestEncodeString(random_bytes(3)) +     // gas limit
+      RLPTestEncodeString(random_bytes(20)) +    // to
+      RLPTestEncodeString(random_bytes(8)) +     // value
+      RLPTestEncodeString(random_bytes(68)) +    // data
+      RLPTestEncodeString(std::string(1, 37)) +  // v
+      RLPTestEncodeString(random_bytes(32)) +    // r
+      RLPTestEncodeString(random_bytes(32));     // s
+  return RLPTestEncodeList(payload);
+}
+
 std::string RLPTestValueToString(const base::Value& val) {
   std::string output;
   if (val.is_string()) {
@@ -396,4 +662,137 @@ TEST(RLPDecodeTest, InvalidInputLessThanLongLengthList2) {
   ASSERT_TRUE(val.is_none());
 }
 
+TEST(RLPDecodeTest, ItemsReferToInput) {
+  const std::string input = FromHex("0xcc83646f6783676f6483636174");
+  const auto bytes = base::as_bytes(base::make_span(input));
+
+  RLPItem item;
+  ASSERT_TRUE(RLPDecode(bytes, &item));
+  ASSERT_TRUE(item.is_list);
+  EXPECT_EQ(bytes.data() + 1, item.data.data());
+  EXPECT_EQ(bytes.size() - 1, item.data.size());
+
+  ASSERT_EQ(3u, item.items.size());
+  EXPECT_FALSE(item.items[1].is_list);
+  EXPECT_EQ(bytes.data() + 6, item.items[1].data.data());
+  EXPECT_EQ("['dog', 'god', 'cat']",
+            RLPTestValueToString(RLPItemToValue(item)));
+}
+
+TEST(RLPDecodeTest, InvalidItemIsReset) {
+  const std::string input = FromHex("0xcc83646f6783676f6483636174");
+  RLPItem item;
+  ASSERT_TRUE(RLPDecode(base::as_bytes(base::make_span(input)), &item));
+
+  const std::string invalid_input = FromHex("0xc5010203");
+  ASSERT_FALSE(
+      RLPDecode(base::as_bytes(base::make_span(invalid_input)), &item));
+  EXPECT_FALSE(item.is_list);
+  EXPECT_TRUE(item.data.empty());
+  EXPECT_TRUE(item.items.empty());
+}
+
+TEST(RLPDecodeTest, MatchesLegacyDecoderForRandomInput) {
+  const int kInputs = 20000;
+
+  std::mt19937 generator(42);
+  for (int i = 0; i < kInputs; i++) {
+    std::string input;
+    if (i % 7 == 0) {
+      // Arbitrary bytes, which are mostly invalid
+      const size_t length = generator() % 12;
+      for (size_t j = 0; j < length; j++) {
+        input.push_back(static_cast<char>(generator() % 256));
+      }
+    } else {
+      input = GenerateRLP(&generator, 4);
+      MutateRLP(&generator, i % 4, &input);
+    }
+
+    base::Value expected_val;
+    const bool expected_result = LegacyRLPDecode(input, &expected_val);
+
+    base::Value val;
+    ASSERT_EQ(expected_result, RLPDecode(input, &val))
+        << base::HexEncode(input.data(), input.size());
+    ASSERT_EQ(expected_val, val)
+        << base::HexEncode(input.data(), input.size());
+  }
+}
+
+TEST(RLPDecodeTest, BenchmarkDecode) {
+  const int kNestedListIterations = 5;
+  const int kTransactions = 10000;
+
+  // About 1 MB of lists nested three levels deep, which hold lists of strings
+  std::string leaf_payload;
+  for (int i = 0; i < 8; i++) {
+    const char c = static_cast<char>('a' + i);
+    leaf_payload += RLPTestEncodeString(std::string(16, c));
+  }
+  std::string input = RLPTestEncodeList(leaf_payload);
+  for (int level = 0; level < 3; level++) {
+    std::string payload;
+    for (int i = 0; i < 20; i++) {
+      payload += input;
+    }
+    input = RLPTestEncodeList(payload);
+  }
+
+  std::mt19937 generator(42);
+  std::vector<std::string> transactions;
+  for (int i = 0; i < kTransactions; i++) {
+    transactions.push_back(GenerateSignedTransaction(&generator));
+  }
+
+  base::ElapsedTimer legacy_nested_list_timer;
+  for (int i = 0; i < kNestedListIterations; i++) {
+    base::Value val;
+    EXPECT_TRUE(LegacyRLPDecode(input, &val));
+  }
+  const base::TimeDelta legacy_nested_list_time =
+      legacy_nested_list_timer.Elapsed();
+
+  base::ElapsedTimer nested_list_timer;
+  for (int i = 0; i < kNestedListIterations; i++) {
+    RLPItem item;
+    EXPECT_TRUE(RLPDecode(base::as_bytes(base::make_span(input)), &item));
+  }
+  const base::TimeDelta nested_list_time = nested_list_timer.Elapsed();
+
+  base::ElapsedTimer legacy_transaction_timer;
+  for (const auto& transaction : transactions) {
+    base::Value val;
+    EXPECT_TRUE(LegacyRLPDecode(transaction, &val));
+  }
+  const base::TimeDelta legacy_transaction_time =
+      legacy_transaction_timer.Elapsed();
+
+  base::ElapsedTimer transaction_timer;
+  for (const auto& transaction : transactions) {
+    RLPItem item;
+    EXPECT_TRUE(
+        RLPDecode(base::as_bytes(base::make_span(transaction)), &item));
+  }
+  const base::TimeDelta transaction_time = transaction_timer.Elapsed();
+
+  base::ElapsedTimer transaction_value_timer;
+  for (const auto& transaction : transactions) {
+    base::Value val;
+    EXPECT_TRUE(RLPDecode(transaction, &val));
+  }
+  const base::TimeDelta transaction_value_time =
+      transaction_value_timer.Elapsed();
+
+  VLOG(1) << kNestedListIterations << " nested lists of " << input.size()
+          << " bytes: " << legacy_nested_list_time.InMicroseconds()
+          << "us copying, " << nested_list_time.InMicroseconds()
+          << "us with views";
+  VLOG(1) << kTransactions << " signed transactions: "
+          << legacy_transaction_time.InMicroseconds() << "us copying, "
+          << transaction_time.InMicroseconds() << "us with views, "
+          << transaction_value_time.InMicroseconds()
+          << "us with views converted to values";
+}
+
 }  // namespace brave_wallet
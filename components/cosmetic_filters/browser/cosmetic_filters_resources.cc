@@ -5,69 +5,90 @@
 
 #include "brave/components/cosmetic_filters/browser/cosmetic_filters_resources.h"
 
+#include <string>
 #include <utility>
 
-#include "base/json/json_reader.h"
+#include "base/bind.h"
+#include "base/no_destructor.h"
 #include "base/optional.h"
 #include "base/values.h"
+#include "brave/components/brave_shields/browser/ad_block_engine_generation_cache.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "components/content_settings/core/browser/host_content_settings_map.h"
+#include "url/gurl.h"
 
 namespace cosmetic_filters {
 
+namespace {
+
+constexpr size_t kMaxCachedUrls = 100;
+
+using UrlCosmeticResourcesCache =
+    brave_shields::AdBlockEngineGenerationCache<base::Value>;
+
+// Shared by the frames of all regular profiles, only used on the UI thread
+UrlCosmeticResourcesCache* GetUrlCosmeticResourcesCache() {
+  static base::NoDestructor<UrlCosmeticResourcesCache> cache(kMaxCachedUrls);
+  return cache.get();
+}
+
+// Rules can match on any part of the URL ($generichide exceptions, scriptlets
+// for a path...) except the fragment, which is never sent to the engines
+std::string GetUrlCosmeticResourcesCacheKey(const std::string& url) {
+  GURL::Replacements replacements;
+  replacements.ClearRef();
+  return GURL(url).ReplaceComponents(replacements).spec();
+}
+
+}  // namespace
+
 CosmeticFiltersResources::CosmeticFiltersResources(
     HostContentSettingsMap* settings_map,
-    brave_shields::AdBlockService* ad_block_service)
+    brave_shields::AdBlockService* ad_block_service,
+    bool is_off_the_record)
     : settings_map_(settings_map),
       ad_block_service_(ad_block_service),
+      is_off_the_record_(is_off_the_record),
       weak_factory_(this) {}
 
 CosmeticFiltersResources::~CosmeticFiltersResources() {}
 
 void CosmeticFiltersResources::HiddenClassIdSelectors(
-    const std::string& input,
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
     const std::vector<std::string>& exceptions,
     HiddenClassIdSelectorsCallback callback) {
-  base::Optional<base::Value> input_value = base::JSONReader::Read(input);
-  if (!input_value || !input_value->is_dict()) {
-    // Nothing to work with
-    std::move(callback).Run(base::Value());
-
-    return;
+  const uint64_t engine_generation =
+      brave_shields::AdBlockBaseService::GetEngineGeneration();
+  if (engine_generation != resolved_engine_generation_) {
+    resolved_classes_.clear();
+    resolved_ids_.clear();
+    resolved_engine_generation_ = engine_generation;
   }
-  base::DictionaryValue* input_dict;
-  if (!input_value->GetAsDictionary(&input_dict)) {
-    std::move(callback).Run(base::Value());
 
-    return;
+  std::vector<std::string> new_classes;
+  for (const auto& class_name : classes) {
+    if (resolved_classes_.insert(class_name).second)
+      new_classes.push_back(class_name);
   }
-  std::vector<std::string> classes;
-  base::ListValue* classes_list;
-  if (input_dict->GetList("classes", &classes_list)) {
-    for (size_t i = 0; i < classes_list->GetSize(); i++) {
-      if (!classes_list->GetList()[i].is_string()) {
-        continue;
-      }
-      classes.push_back(classes_list->GetList()[i].GetString());
-    }
+  std::vector<std::string> new_ids;
+  for (const auto& id : ids) {
+    if (resolved_ids_.insert(id).second)
+      new_ids.push_back(id);
   }
-  std::vector<std::string> ids;
-  base::ListValue* ids_list;
-  if (input_dict->GetList("ids", &ids_list)) {
-    for (size_t i = 0; i < ids_list->GetSize(); i++) {
-      if (!ids_list->GetList()[i].is_string()) {
-        continue;
-      }
-      ids.push_back(ids_list->GetList()[i].GetString());
-    }
+
+  if (new_classes.empty() && new_ids.empty()) {
+    // Everything was already resolved, the selectors are in place
+    std::move(callback).Run(base::Value(base::Value::Type::LIST));
+    return;
   }
 
   ad_block_service_->GetTaskRunner()->PostTaskAndReplyWithResult(
       FROM_HERE,
       base::BindOnce(&brave_shields::AdBlockService::HiddenClassIdSelectors,
-                     base::Unretained(ad_block_service_), classes, ids,
-                     exceptions),
+                     base::Unretained(ad_block_service_),
+                     std::move(new_classes), std::move(new_ids), exceptions),
       base::BindOnce(&CosmeticFiltersResources::HiddenClassIdSelectorsOnUI,
                      weak_factory_.GetWeakPtr(), std::move(callback)));
 }
@@ -81,9 +102,19 @@ void CosmeticFiltersResources::HiddenClassIdSelectorsOnUI(
 
 void CosmeticFiltersResources::UrlCosmeticResourcesOnUI(
     UrlCosmeticResourcesCallback callback,
+    const std::string& cache_key,
+    uint64_t engine_generation,
     base::Optional<base::Value> resources) {
-  std::move(callback).Run(resources ? std::move(resources.value())
-                                    : base::Value());
+  if (!resources) {
+    std::move(callback).Run(base::Value());
+    return;
+  }
+
+  if (!is_off_the_record_) {
+    GetUrlCosmeticResourcesCache()->Put(cache_key, engine_generation,
+                                        resources->Clone());
+  }
+  std::move(callback).Run(std::move(resources.value()));
 }
 
 void CosmeticFiltersResources::ShouldDoCosmeticFiltering(
@@ -100,12 +131,33 @@ void CosmeticFiltersResources::ShouldDoCosmeticFiltering(
 void CosmeticFiltersResources::UrlCosmeticResources(
     const std::string& url,
     UrlCosmeticResourcesCallback callback) {
+  // A new document is being loaded into the frame
+  resolved_classes_.clear();
+  resolved_ids_.clear();
+
+  // Anything computed from now on is tagged with the current generation, so
+  // that it is discarded if an engine changes while the query runs
+  const uint64_t engine_generation =
+      brave_shields::AdBlockBaseService::GetEngineGeneration();
+  const std::string cache_key = GetUrlCosmeticResourcesCacheKey(url);
+
+  // Off-the-record frames don't leave their URLs in the shared cache
+  if (!is_off_the_record_) {
+    const base::Value* resources =
+        GetUrlCosmeticResourcesCache()->Get(cache_key, engine_generation);
+    if (resources) {
+      std::move(callback).Run(resources->Clone());
+      return;
+    }
+  }
+
   ad_block_service_->GetTaskRunner()->PostTaskAndReplyWithResult(
       FROM_HERE,
       base::BindOnce(&brave_shields::AdBlockService::UrlCosmeticResources,
                      base::Unretained(ad_block_service_), url),
       base::BindOnce(&CosmeticFiltersResources::UrlCosmeticResourcesOnUI,
-                     weak_factory_.GetWeakPtr(), std::move(callback)));
+                     weak_factory_.GetWeakPtr(), std::move(callback),
+                     cache_key, engine_generation));
 }
 
 }  // namespace cosmetic_filters
@@ -6,10 +6,13 @@
 #ifndef BRAVE_COMPONENTS_COSMETIC_FILTERS_BROWSER_COSMETIC_FILTERS_RESOURCES_H_
 #define BRAVE_COMPONENTS_COSMETIC_FILTERS_BROWSER_COSMETIC_FILTERS_RESOURCES_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "base/containers/flat_set.h"
 #include "base/memory/weak_ptr.h"
 #include "base/optional.h"
 #include "base/values.h"
@@ -25,6 +28,9 @@ namespace cosmetic_filters {
 
 // CosmeticFiltersResources is a class that is responsible for interaction
 // between CosmeticFiltersJSHandler class that lives inside renderer process.
+// There is one instance per frame. Results are cached per URL across frames
+// of regular profiles and per frame for class and id selectors, until any
+// ad-block engine changes.
 
 class CosmeticFiltersResources final
     : public cosmetic_filters::mojom::CosmeticFiltersResources {
@@ -32,7 +38,8 @@ class CosmeticFiltersResources final
   CosmeticFiltersResources(const CosmeticFiltersResources&) = delete;
   CosmeticFiltersResources& operator=(const CosmeticFiltersResources&) = delete;
   CosmeticFiltersResources(HostContentSettingsMap* settings_map,
-                           brave_shields::AdBlockService* ad_block_service);
+                           brave_shields::AdBlockService* ad_block_service,
+                           bool is_off_the_record);
   ~CosmeticFiltersResources() override;
 
   // Sends back to renderer a response: do we need to apply cosmetic filters
@@ -42,8 +49,10 @@ class CosmeticFiltersResources final
       ShouldDoCosmeticFilteringCallback callback) override;
 
   // Sends back to renderer a response about rules that has to be applied
-  // for the specified selectors.
-  void HiddenClassIdSelectors(const std::string& input,
+  // for the specified selectors. Classes and ids already resolved for the
+  // frame are skipped.
+  void HiddenClassIdSelectors(const std::vector<std::string>& classes,
+                              const std::vector<std::string>& ids,
                               const std::vector<std::string>& exceptions,
                               HiddenClassIdSelectorsCallback callback) override;
 
@@ -57,10 +66,18 @@ class CosmeticFiltersResources final
                                   base::Optional<base::Value> resources);
 
   void UrlCosmeticResourcesOnUI(UrlCosmeticResourcesCallback callback,
+                                const std::string& cache_key,
+                                uint64_t engine_generation,
                                 base::Optional<base::Value> resources);
 
   HostContentSettingsMap* settings_map_;             // Not owned
   brave_shields::AdBlockService* ad_block_service_;  // Not owned
+  const bool is_off_the_record_;
+
+  // Class and id selectors already sent to the frame's current document
+  base::flat_set<std::string> resolved_classes_;
+  base::flat_set<std::string> resolved_ids_;
+  uint64_t resolved_engine_generation_ = 0;
 
   base::WeakPtrFactory<CosmeticFiltersResources> weak_factory_;
 };
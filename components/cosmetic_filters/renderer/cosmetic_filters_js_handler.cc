@@ -8,12 +8,14 @@
 #include <utility>
 
 #include "base/bind.h"
-#include "base/json/json_writer.h"
 #include "base/no_destructor.h"
+#include "base/stl_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/trace_event/trace_event.h"
 #include "brave/components/cosmetic_filters/resources/grit/cosmetic_filters_generated_map.h"
 #include "content/public/renderer/render_frame.h"
+#include "content/public/renderer/v8_value_converter.h"
 #include "gin/arguments.h"
 #include "gin/function_template.h"
 #include "net/base/registry_controlled_domains/registry_controlled_domain.h"
@@ -26,132 +28,118 @@
 
 namespace {
 
-static base::NoDestructor<std::string> g_observing_script("");
+static base::NoDestructor<std::string> g_apply_rules_script("");
 
 static base::NoDestructor<std::vector<std::string>> g_vetted_search_engines(
     {"duckduckgo", "qwant", "bing", "startpage", "google", "yandex", "ecosia"});
 
-const char kScriptletInitScript[] =
-    R"((function() {
-          let text = %s;
-          let script;
-          try {
-            script = document.createElement('script');
-            const textNode = document.createTextNode(text);
-            script.appendChild(textNode);;
-            (document.head || document.documentElement).appendChild(script);
-          } catch (ex) {
-            /* Unused catch */
+// The observing script is spliced in once at startup, so the source is the
+// same for every call and V8 only compiles it once. The rules to apply are
+// passed in as a V8 object rather than serialized into the source.
+const char kApplyRulesScript[] =
+    R"((function(rules) {
+          const observe = function() {
+            %s
+          };
+          if (typeof rules.scriptlet === 'string') {
+            let script;
+            try {
+              script = document.createElement('script');
+              const textNode = document.createTextNode(rules.scriptlet);
+              script.appendChild(textNode);
+              (document.head || document.documentElement).appendChild(script);
+            } catch (ex) {
+              /* Unused catch */
+            }
+            if (script) {
+              if (script.parentNode) {
+                script.parentNode.removeChild(script);
+              }
+              script.textContent = '';
+            }
           }
-          if (script) {
-            if (script.parentNode) {
-              script.parentNode.removeChild(script);
+          if (rules.init) {
+            if (window.content_cosmetic == undefined) {
+              window.content_cosmetic = {};
             }
-            script.textContent = '';
+            if (window.content_cosmetic.hide1pContent === undefined) {
+              window.content_cosmetic.hide1pContent = rules.init.hide1pContent;
+            }
+            if (window.content_cosmetic.generichide === undefined) {
+              window.content_cosmetic.generichide = rules.init.generichide;
+            }
+            observe();
           }
-        })();)";
-
-const char kPreInitScript[] =
-    R"((function() {
-          if (window.content_cosmetic == undefined) {
-            window.content_cosmetic = {};
+          if (!rules.hideSelectors && !rules.forceHideSelectors &&
+              !rules.styleSelectors) {
+            if (rules.observe) {
+              observe();
+            }
+            return;
           }
-          %s
-        })();)";
-
-const char kCosmeticFilteringInitScript[] =
-    R"(if (window.content_cosmetic.hide1pContent === undefined) {
-        window.content_cosmetic.hide1pContent = %s;
-       }
-       if (window.content_cosmetic.generichide === undefined) {
-         window.content_cosmetic.generichide = %s;
-       })";
-
-const char kHideSelectorsInjectScript[] =
-    R"((function() {
-          let nextIndex =
-              window.content_cosmetic.cosmeticStyleSheet.rules.length;
-          const selectors = %s;
-          selectors.forEach(selector => {
+          const CC = window.content_cosmetic;
+          let nextIndex = CC.cosmeticStyleSheet.rules.length;
+          const insertRule = (selector, rule) => {
+            CC.cosmeticStyleSheet.insertRule(`${rule}`, nextIndex);
+            if (!CC.hide1pContent) {
+              CC.allSelectorsToRules.set(selector, nextIndex);
+            }
+            nextIndex++;
+          };
+          (rules.hideSelectors || []).forEach(selector => {
             if ((typeof selector === 'string') &&
-                (window.content_cosmetic.hide1pContent ||
-                !window.content_cosmetic.allSelectorsToRules.has(selector))) {
-              let rule = selector + '{display:none !important;}';
-              window.content_cosmetic.cosmeticStyleSheet.insertRule(
-                `${rule}`, nextIndex);
-              if (!window.content_cosmetic.hide1pContent) {
-                window.content_cosmetic.allSelectorsToRules.set(
-                  selector, nextIndex);
-                window.content_cosmetic.firstRunQueue.add(selector);
+                (CC.hide1pContent || !CC.allSelectorsToRules.has(selector))) {
+              insertRule(selector, selector + '{display:none !important;}');
+              if (!CC.hide1pContent) {
+                CC.firstRunQueue.add(selector);
               }
-              nextIndex++;
             }
           });
-          if (!document.adoptedStyleSheets.includes(
-              window.content_cosmetic.cosmeticStyleSheet)) {
-            document.adoptedStyleSheets =
-              [window.content_cosmetic.cosmeticStyleSheet,
-                ...document.adoptedStyleSheets];
-          };
-        })();)";
-
-const char kForceHideSelectorsInjectScript[] =
-    R"((function() {
-          let nextIndex =
-              window.content_cosmetic.cosmeticStyleSheet.rules.length;
-          const selectors = %s;
-          selectors.forEach(selector => {
+          (rules.forceHideSelectors || []).forEach(selector => {
             if (typeof selector === 'string') {
-              let rule = selector + '{display:none !important;}';
-              window.content_cosmetic.cosmeticStyleSheet.insertRule(
-                `${rule}`, nextIndex);
-              if (!window.content_cosmetic.hide1pContent) {
-                window.content_cosmetic.allSelectorsToRules.set(
-                  selector, nextIndex);
-              }
-              nextIndex++;
+              insertRule(selector, selector + '{display:none !important;}');
             }
           });
-          if (!document.adoptedStyleSheets.includes(
-              window.content_cosmetic.cosmeticStyleSheet)) {
-            document.adoptedStyleSheets =
-              [window.content_cosmetic.cosmeticStyleSheet,
-                ...document.adoptedStyleSheets];
-          };
-        })();)";
-
-const char kStyleSelectorsInjectScript[] =
-    R"((function() {
-          let nextIndex =
-              window.content_cosmetic.cosmeticStyleSheet.rules.length;
-          const selectors = %s;
-          for (let selector in selectors) {
-            if (window.content_cosmetic.hide1pContent ||
-                !window.content_cosmetic.allSelectorsToRules.has(selector)) {
+          const styleSelectors = rules.styleSelectors || {};
+          for (let selector in styleSelectors) {
+            if (CC.hide1pContent || !CC.allSelectorsToRules.has(selector)) {
               let rule = selector + '{';
-              selectors[selector].forEach(prop => {
+              styleSelectors[selector].forEach(prop => {
                 if (!rule.endsWith('{')) {
                   rule += ';';
                 }
                 rule += prop;
               });
               rule += '}';
-              window.content_cosmetic.cosmeticStyleSheet.insertRule(
-                `${rule}`, nextIndex);
-              if (!window.content_cosmetic.hide1pContent) {
-                window.content_cosmetic.allSelectorsToRules.set(
-                  selector, nextIndex);
-              }
-              nextIndex++;
-            };
-          };
-          if (!document.adoptedStyleSheets.includes(
-                window.content_cosmetic.cosmeticStyleSheet)){
-             document.adoptedStyleSheets =
-               [window.content_cosmetic.cosmeticStyleSheet,
-                 ...document.adoptedStyleSheets];
-          };
-        })();)";
+              insertRule(selector, rule);
+            }
+          }
+          if (!document.adoptedStyleSheets.includes(CC.cosmeticStyleSheet)) {
+            document.adoptedStyleSheets =
+              [CC.cosmeticStyleSheet, ...document.adoptedStyleSheets];
+          }
+          if (rules.observe) {
+            observe();
+          }
+        }))";
+
+// Sets |name| on |object| unless |value| is missing or empty.
+void SetRule(v8::Local<v8::Context> context,
+             v8::Local<v8::Object> object,
+             const std::string& name,
+             const base::Value* value,
+             content::V8ValueConverter* converter) {
+  if (!value)
+    return;
+  if ((value->is_list() && value->GetList().empty()) ||
+      (value->is_dict() && value->DictEmpty()))
+    return;
+
+  object
+      ->Set(context, gin::StringToSymbol(context->GetIsolate(), name),
+            converter->ToV8Value(value, context))
+      .Check();
+}
 
 std::string LoadDataResource(const int id) {
   auto& resource_bundle = ui::ResourceBundle::GetSharedInstance();
@@ -191,8 +179,10 @@ CosmeticFiltersJSHandler::CosmeticFiltersJSHandler(
     : render_frame_(render_frame),
       isolated_world_id_(isolated_world_id),
       enabled_1st_party_cf_(false) {
-  if (g_observing_script->empty()) {
-    *g_observing_script = LoadDataResource(kCosmeticFiltersGenerated[0].id);
+  if (g_apply_rules_script->empty()) {
+    *g_apply_rules_script = base::StringPrintf(
+        kApplyRulesScript,
+        LoadDataResource(kCosmeticFiltersGenerated[0].id).c_str());
   }
   EnsureConnected();
 }
@@ -200,12 +190,13 @@ CosmeticFiltersJSHandler::CosmeticFiltersJSHandler(
 CosmeticFiltersJSHandler::~CosmeticFiltersJSHandler() = default;
 
 void CosmeticFiltersJSHandler::HiddenClassIdSelectors(
-    const std::string& input) {
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids) {
   if (!EnsureConnected())
     return;
 
   cosmetic_filters_resources_->HiddenClassIdSelectors(
-      input, exceptions_,
+      classes, ids, exceptions_,
       base::BindOnce(&CosmeticFiltersJSHandler::OnHiddenClassIdSelectors,
                      base::Unretained(this)));
 }
@@ -315,108 +306,43 @@ void CosmeticFiltersJSHandler::ApplyRules() {
   if (!resources_dict_ || web_frame->IsProvisional())
     return;
 
-  std::string scriptlet_script;
-  base::Value* injected_script = resources_dict_->FindPath("injected_script");
-  if (injected_script &&
-      base::JSONWriter::Write(*injected_script, &scriptlet_script)) {
-    scriptlet_script =
-        base::StringPrintf(kScriptletInitScript, scriptlet_script.c_str());
+  InjectedRules rules;
+  rules.scriptlet = resources_dict_->FindKey("injected_script");
+  if (render_frame_->IsMainFrame()) {
+    // Working on css rules, we do that on a main frame only
+    rules.init = true;
+    rules.generichide =
+        resources_dict_->FindBoolKey("generichide").value_or(false);
+    CSSRulesRoutine(resources_dict_.get(), &rules);
   }
-  if (!scriptlet_script.empty()) {
-    web_frame->ExecuteScriptInIsolatedWorld(
-        isolated_world_id_, blink::WebString::FromUTF8(scriptlet_script));
-  }
-  if (!render_frame_->IsMainFrame())
+
+  if (!rules.scriptlet && !rules.init)
     return;
 
-  // Working on css rules, we do that on a main frame only
-  bool generichide = false;
-  resources_dict_->GetBoolean("generichide", &generichide);
-  std::string cosmetic_filtering_init_script = base::StringPrintf(
-      kCosmeticFilteringInitScript, enabled_1st_party_cf_ ? "true" : "false",
-      generichide ? "true" : "false");
-  std::string pre_init_script = base::StringPrintf(
-      kPreInitScript, cosmetic_filtering_init_script.c_str());
-
-  web_frame->ExecuteScriptInIsolatedWorld(
-      isolated_world_id_, blink::WebString::FromUTF8(pre_init_script));
-  web_frame->ExecuteScriptInIsolatedWorld(
-      isolated_world_id_, blink::WebString::FromUTF8(*g_observing_script));
-
-  CSSRulesRoutine(resources_dict_.get());
+  ExecuteRules(rules);
 }
 
 void CosmeticFiltersJSHandler::CSSRulesRoutine(
-    base::DictionaryValue* resources_dict) {
+    base::DictionaryValue* resources_dict,
+    InjectedRules* rules) {
   // Otherwise, if its a vetted engine AND we're not in aggressive
   // mode, also don't do cosmetic filtering.
   if (!enabled_1st_party_cf_ && IsVettedSearchEngine(url_))
     return;
 
-  blink::WebLocalFrame* web_frame = render_frame_->GetWebFrame();
   base::ListValue* cf_exceptions_list;
   if (resources_dict->GetList("exceptions", &cf_exceptions_list)) {
     for (size_t i = 0; i < cf_exceptions_list->GetSize(); i++) {
       exceptions_.push_back(cf_exceptions_list->GetList()[i].GetString());
     }
   }
-  base::ListValue* hide_selectors_list;
-  if (!resources_dict->GetList("hide_selectors", &hide_selectors_list)) {
-    hide_selectors_list = nullptr;
-  }
-  base::ListValue* force_hide_selectors_list;
-  if (!resources_dict->GetList("force_hide_selectors",
-                               &force_hide_selectors_list)) {
-    force_hide_selectors_list = nullptr;
-  }
-
-  if (hide_selectors_list && hide_selectors_list->GetSize() != 0) {
-    std::string json_selectors;
-    if (!base::JSONWriter::Write(*hide_selectors_list, &json_selectors) ||
-        json_selectors.empty()) {
-      json_selectors = "[]";
-    }
-    // Building a script for stylesheet modifications
-    std::string new_selectors_script =
-        base::StringPrintf(kHideSelectorsInjectScript, json_selectors.c_str());
-    web_frame->ExecuteScriptInIsolatedWorld(
-        isolated_world_id_, blink::WebString::FromUTF8(new_selectors_script));
-  }
-
-  if (force_hide_selectors_list && force_hide_selectors_list->GetSize() != 0) {
-    std::string json_selectors;
-    if (!base::JSONWriter::Write(*force_hide_selectors_list, &json_selectors) ||
-        json_selectors.empty()) {
-      json_selectors = "[]";
-    }
-    // Building a script for stylesheet modifications
-    std::string new_selectors_script = base::StringPrintf(
-        kForceHideSelectorsInjectScript, json_selectors.c_str());
-    web_frame->ExecuteScriptInIsolatedWorld(
-        isolated_world_id_, blink::WebString::FromUTF8(new_selectors_script));
-  }
 
-  base::DictionaryValue* style_selectors_dictionary = nullptr;
-  if (resources_dict->GetDictionary("style_selectors",
-                                    &style_selectors_dictionary)) {
-    std::string json_selectors;
-    if (!base::JSONWriter::Write(*style_selectors_dictionary,
-                                 &json_selectors) ||
-        json_selectors.empty()) {
-      json_selectors = "[]";
-    }
-    std::string new_selectors_script =
-        base::StringPrintf(kStyleSelectorsInjectScript, json_selectors.c_str());
-    if (!json_selectors.empty()) {
-      web_frame->ExecuteScriptInIsolatedWorld(
-          isolated_world_id_, blink::WebString::FromUTF8(new_selectors_script));
-    }
-  }
-
-  if (!enabled_1st_party_cf_) {
-    web_frame->ExecuteScriptInIsolatedWorld(
-        isolated_world_id_, blink::WebString::FromUTF8(*g_observing_script));
-  }
+  // The observing script is already started by |init|, so there is no need to
+  // run it again for these selectors
+  rules->hide_selectors = resources_dict->FindListKey("hide_selectors");
+  rules->force_hide_selectors =
+      resources_dict->FindListKey("force_hide_selectors");
+  rules->style_selectors = resources_dict->FindDictKey("style_selectors");
 }
 
 void CosmeticFiltersJSHandler::OnHiddenClassIdSelectors(base::Value result) {
@@ -428,28 +354,67 @@ void CosmeticFiltersJSHandler::OnHiddenClassIdSelectors(base::Value result) {
   // We expect a List value from adblock service. That is
   // an extra check to be sure that adblock file exist and gives us
   // rules that we expect
-  base::ListValue* selectors_list;
-  if (!result.GetAsList(&selectors_list))
+  if (!result.is_list())
+    return;
+
+  InjectedRules rules;
+  rules.hide_selectors = &result;
+  rules.observe = !enabled_1st_party_cf_;
+  if (result.GetList().empty() && !rules.observe)
     return;
 
+  ExecuteRules(rules);
+}
+
+void CosmeticFiltersJSHandler::ExecuteRules(const InjectedRules& rules) {
+  TRACE_EVENT0("renderer", "CosmeticFiltersJSHandler::ExecuteRules");
+
   blink::WebLocalFrame* web_frame = render_frame_->GetWebFrame();
-  std::string json_selectors;
-  if (!base::JSONWriter::Write(*selectors_list, &json_selectors) ||
-      json_selectors.empty()) {
-    json_selectors = "[]";
+  v8::Isolate* isolate = blink::MainThreadIsolate();
+  v8::HandleScope handle_scope(isolate);
+
+  v8::Local<v8::Value> apply_rules =
+      web_frame->ExecuteScriptInIsolatedWorldAndReturnValue(
+          isolated_world_id_, blink::WebString::FromUTF8(*g_apply_rules_script));
+  if (apply_rules.IsEmpty() || !apply_rules->IsFunction())
+    return;
+
+  v8::Local<v8::Function> function = apply_rules.As<v8::Function>();
+  v8::Local<v8::Context> context = function->CreationContext();
+  v8::Context::Scope context_scope(context);
+
+  std::unique_ptr<content::V8ValueConverter> converter =
+      content::V8ValueConverter::Create();
+  v8::Local<v8::Object> rules_object = v8::Object::New(isolate);
+  if (rules.scriptlet && rules.scriptlet->is_string()) {
+    SetRule(context, rules_object, "scriptlet", rules.scriptlet,
+            converter.get());
   }
-  // Building a script for stylesheet modifications
-  std::string new_selectors_script =
-      base::StringPrintf(kHideSelectorsInjectScript, json_selectors.c_str());
-  if (selectors_list->GetSize() != 0) {
-    web_frame->ExecuteScriptInIsolatedWorld(
-        isolated_world_id_, blink::WebString::FromUTF8(new_selectors_script));
+  if (rules.init) {
+    v8::Local<v8::Object> init = v8::Object::New(isolate);
+    init->Set(context, gin::StringToSymbol(isolate, "hide1pContent"),
+              v8::Boolean::New(isolate, enabled_1st_party_cf_))
+        .Check();
+    init->Set(context, gin::StringToSymbol(isolate, "generichide"),
+              v8::Boolean::New(isolate, rules.generichide))
+        .Check();
+    rules_object->Set(context, gin::StringToSymbol(isolate, "init"), init)
+        .Check();
   }
+  SetRule(context, rules_object, "hideSelectors", rules.hide_selectors,
+          converter.get());
+  SetRule(context, rules_object, "forceHideSelectors",
+          rules.force_hide_selectors, converter.get());
+  SetRule(context, rules_object, "styleSelectors", rules.style_selectors,
+          converter.get());
+  rules_object
+      ->Set(context, gin::StringToSymbol(isolate, "observe"),
+            v8::Boolean::New(isolate, rules.observe))
+      .Check();
 
-  if (!enabled_1st_party_cf_) {
-    web_frame->ExecuteScriptInIsolatedWorld(
-        isolated_world_id_, blink::WebString::FromUTF8(*g_observing_script));
-  }
+  v8::Local<v8::Value> argv[] = {rules_object};
+  web_frame->CallFunctionEvenIfScriptDisabled(function, context->Global(),
+                                              base::size(argv), argv);
 }
 
 }  // namespace cosmetic_filters
@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 
+#include "base/values.h"
 #include "brave/components/cosmetic_filters/common/cosmetic_filters.mojom.h"
 #include "content/public/renderer/render_frame.h"
 #include "content/public/renderer/render_frame_observer.h"
@@ -50,14 +51,33 @@ class CosmeticFiltersJSHandler {
   void CreateWorkerObject(v8::Isolate* isolate, v8::Local<v8::Context> context);
 
   // A function to be called from JS
-  void HiddenClassIdSelectors(const std::string& input);
+  void HiddenClassIdSelectors(const std::vector<std::string>& classes,
+                              const std::vector<std::string>& ids);
 
   void OnShouldDoCosmeticFiltering(base::OnceClosure callback,
                                    bool enabled,
                                    bool first_party_enabled);
   void OnUrlCosmeticResources(base::OnceClosure callback, base::Value result);
-  void CSSRulesRoutine(base::DictionaryValue* resources_dict);
+
+  // Everything injected into a frame in one go. The values are owned by the
+  // caller and are converted straight to V8 when the rules are executed.
+  struct InjectedRules {
+    const base::Value* scriptlet = nullptr;
+    // Set up the cosmetic filtering state and start observing the DOM
+    bool init = false;
+    bool generichide = false;
+    const base::Value* hide_selectors = nullptr;
+    const base::Value* force_hide_selectors = nullptr;
+    const base::Value* style_selectors = nullptr;
+    // Run the observing script again to pick up the new selectors
+    bool observe = false;
+  };
+
+  void CSSRulesRoutine(base::DictionaryValue* resources_dict,
+                       InjectedRules* rules);
   void OnHiddenClassIdSelectors(base::Value result);
+  // Compiles and runs a single script in the isolated world for |rules|.
+  void ExecuteRules(const InjectedRules& rules);
 
   content::RenderFrame* render_frame_;
   mojo::Remote<cosmetic_filters::mojom::CosmeticFiltersResources>
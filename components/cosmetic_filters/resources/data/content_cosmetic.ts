@@ -3,11 +3,11 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this file,
 // you can obtain one at http://mozilla.org/MPL/2.0/.
 
-// That script is executed from
-// components/cosmetic_filters/content/renderer/cosmetic_filters_js_handler.cc
-// several times:
-// - for cosmetic filters work with CSS and stylesheet. That work itself
-//   could call the script several times.
+// That script is embedded in the single script injected by
+// components/cosmetic_filters/renderer/cosmetic_filters_js_handler.cc
+// and could run several times per frame:
+// - once the cosmetic filtering state is set up for the frame;
+// - whenever new class and id selectors have been applied.
 
 const { parseDomain, ParseResultType } = require('parse-domain')
 // Start looking for things to unhide before at most this long after
@@ -101,10 +101,7 @@ const fetchNewClassIdRules = () => {
   }
   // Callback to c++ renderer process
   // @ts-ignore
-  cf_worker.hiddenClassIdSelectors(
-      JSON.stringify({
-        classes: notYetQueriedClasses, ids: notYetQueriedIds
-      }))
+  cf_worker.hiddenClassIdSelectors(notYetQueriedClasses, notYetQueriedIds)
   notYetQueriedClasses = []
   notYetQueriedIds = []
 }
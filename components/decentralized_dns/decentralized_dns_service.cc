@@ -10,6 +10,7 @@
 #include "brave/components/decentralized_dns/constants.h"
 #include "brave/components/decentralized_dns/decentralized_dns_service_delegate.h"
 #include "brave/components/decentralized_dns/pref_names.h"
+#include "brave/components/decentralized_dns/resolution_cache.h"
 #include "components/prefs/pref_change_registrar.h"
 #include "components/prefs/pref_registry_simple.h"
 #include "components/prefs/pref_service.h"
@@ -20,7 +21,8 @@ DecentralizedDnsService::DecentralizedDnsService(
     std::unique_ptr<DecentralizedDnsServiceDelegate> delegate,
     content::BrowserContext* context,
     PrefService* local_state)
-    : delegate_(std::move(delegate)) {
+    : delegate_(std::move(delegate)),
+      resolution_cache_(std::make_unique<ResolutionCache>()) {
   pref_change_registrar_ = std::make_unique<PrefChangeRegistrar>();
   pref_change_registrar_->Init(local_state);
   pref_change_registrar_->Add(
@@ -45,6 +47,8 @@ void DecentralizedDnsService::RegisterLocalStatePrefs(
 }
 
 void DecentralizedDnsService::OnPreferenceChanged() {
+  // Cached results may come from a resolve method which is no longer used.
+  resolution_cache_->Clear();
   delegate_->UpdateNetworkService();
 }
 
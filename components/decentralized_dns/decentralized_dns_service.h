@@ -21,6 +21,7 @@ class PrefService;
 namespace decentralized_dns {
 
 class DecentralizedDnsServiceDelegate;
+class ResolutionCache;
 
 class DecentralizedDnsService : public KeyedService {
  public:
@@ -35,11 +36,14 @@ class DecentralizedDnsService : public KeyedService {
 
   static void RegisterLocalStatePrefs(PrefRegistrySimple* registry);
 
+  ResolutionCache* resolution_cache() { return resolution_cache_.get(); }
+
  private:
   void OnPreferenceChanged();
 
   std::unique_ptr<PrefChangeRegistrar> pref_change_registrar_;
   std::unique_ptr<DecentralizedDnsServiceDelegate> delegate_;
+  std::unique_ptr<ResolutionCache> resolution_cache_;
 };
 
 }  // namespace decentralized_dns
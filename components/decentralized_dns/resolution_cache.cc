@@ -0,0 +1,120 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/decentralized_dns/resolution_cache.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+
+namespace decentralized_dns {
+
+namespace {
+
+constexpr base::TimeDelta kResolvedTTL = base::TimeDelta::FromMinutes(30);
+constexpr base::TimeDelta kFailedTTL = base::TimeDelta::FromMinutes(1);
+constexpr size_t kMaxEntries = 100;
+
+}  // namespace
+
+ResolutionCache::ResolutionCache() = default;
+
+ResolutionCache::~ResolutionCache() = default;
+
+void ResolutionCache::Resolve(const std::string& host,
+                              ResolveStarter starter,
+                              ResolveCallback callback) {
+  auto entry = entries_.find(host);
+  if (entry != entries_.end()) {
+    if (entry->second.expiration_time > base::Time::Now()) {
+      base::SequencedTaskRunnerHandle::Get()->PostTask(
+          FROM_HERE, base::BindOnce(std::move(callback), entry->second.success,
+                                    entry->second.result));
+      return;
+    }
+    entries_.erase(entry);
+  }
+
+  auto pending = pending_callbacks_.find(host);
+  if (pending != pending_callbacks_.end()) {
+    pending->second.push_back(std::move(callback));
+    return;
+  }
+  pending_callbacks_[host].push_back(std::move(callback));
+
+  if (!std::move(starter).Run(base::BindOnce(
+          &ResolutionCache::OnResolved, weak_ptr_factory_.GetWeakPtr(), host,
+          generation_))) {
+    // Callers expect the callback to run after Resolve() returns.
+    base::SequencedTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE,
+        base::BindOnce(&ResolutionCache::OnResolved,
+                       weak_ptr_factory_.GetWeakPtr(), host, generation_, false,
+                       std::string()));
+  }
+}
+
+void ResolutionCache::Clear() {
+  ++generation_;
+  entries_.clear();
+
+  // Requests started after this must not join resolutions done with the old
+  // resolve method, so fail the waiting ones instead.
+  std::map<std::string, std::vector<ResolveCallback>> pending;
+  pending.swap(pending_callbacks_);
+  for (auto& it : pending) {
+    for (auto& callback : it.second) {
+      base::SequencedTaskRunnerHandle::Get()->PostTask(
+          FROM_HERE, base::BindOnce(std::move(callback), false, std::string()));
+    }
+  }
+}
+
+void ResolutionCache::OnResolved(const std::string& host,
+                                 uint64_t generation,
+                                 bool success,
+                                 const std::string& result) {
+  // Callbacks of resolutions started before Clear() were already run.
+  if (generation != generation_)
+    return;
+
+  Entry entry;
+  entry.success = success;
+  entry.result = result;
+  entry.expiration_time =
+      base::Time::Now() + (success ? kResolvedTTL : kFailedTTL);
+  entries_[host] = std::move(entry);
+  EvictIfNeeded();
+
+  auto pending = pending_callbacks_.find(host);
+  if (pending == pending_callbacks_.end())
+    return;
+  std::vector<ResolveCallback> callbacks = std::move(pending->second);
+  pending_callbacks_.erase(pending);
+  for (auto& callback : callbacks)
+    std::move(callback).Run(success, result);
+}
+
+void ResolutionCache::EvictIfNeeded() {
+  if (entries_.size() <= kMaxEntries)
+    return;
+
+  const base::Time now = base::Time::Now();
+  auto oldest = entries_.begin();
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.expiration_time <= now) {
+      it = entries_.erase(it);
+      continue;
+    }
+    if (it->second.expiration_time < oldest->second.expiration_time)
+      oldest = it;
+    ++it;
+  }
+  if (entries_.size() > kMaxEntries)
+    entries_.erase(oldest);
+}
+
+}  // namespace decentralized_dns
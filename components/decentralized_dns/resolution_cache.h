@@ -0,0 +1,78 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_DECENTRALIZED_DNS_RESOLUTION_CACHE_H_
+#define BRAVE_COMPONENTS_DECENTRALIZED_DNS_RESOLUTION_CACHE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+
+namespace decentralized_dns {
+
+// Caches results of decentralized DNS resolutions (raw ProxyReader getMany
+// results for Unstoppable Domains) per host, so that navigations and
+// subresource requests to a host resolved recently don't issue another
+// eth_call. Concurrent resolutions of the same host share one request and
+// failed resolutions are cached for a short time as well. Entries are only
+// kept in memory, resolved hosts are never written to the profile.
+class ResolutionCache {
+ public:
+  using ResolveCallback =
+      base::OnceCallback<void(bool success, const std::string& result)>;
+  // Starts a resolution which will run the passed callback once finished.
+  // Returns false if the resolution couldn't be started, in which case the
+  // passed callback is never run.
+  using ResolveStarter = base::OnceCallback<bool(ResolveCallback)>;
+
+  ResolutionCache();
+  ~ResolutionCache();
+
+  ResolutionCache(const ResolutionCache&) = delete;
+  ResolutionCache& operator=(const ResolutionCache&) = delete;
+
+  // Runs |callback| asynchronously with the cached result for |host| if there
+  // is a fresh one, otherwise joins the in-flight resolution of |host| or runs
+  // |starter| to begin a new one. |callback| never runs before this returns.
+  void Resolve(const std::string& host,
+               ResolveStarter starter,
+               ResolveCallback callback);
+
+  // Drops all cached results, e.g. when the resolve method changes.
+  // Callbacks waiting on resolutions in flight are run with a failure and
+  // those results aren't cached.
+  void Clear();
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    bool success = false;
+    std::string result;
+    base::Time expiration_time;
+  };
+
+  void OnResolved(const std::string& host,
+                  uint64_t generation,
+                  bool success,
+                  const std::string& result);
+  void EvictIfNeeded();
+
+  std::map<std::string, Entry> entries_;
+  std::map<std::string, std::vector<ResolveCallback>> pending_callbacks_;
+  // Bumped by Clear() so results of resolutions started before it are
+  // ignored.
+  uint64_t generation_ = 0;
+
+  base::WeakPtrFactory<ResolutionCache> weak_ptr_factory_{this};
+};
+
+}  // namespace decentralized_dns
+
+#endif  // BRAVE_COMPONENTS_DECENTRALIZED_DNS_RESOLUTION_CACHE_H_
@@ -6,7 +6,9 @@
 #include "brave/components/greaselion/browser/greaselion_service_impl.h"
 
 #include <stddef.h>
+#include <algorithm>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -15,12 +17,16 @@
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/command_line.h"
+#include "base/containers/contains.h"
 #include "base/feature_list.h"
+#include "base/files/file_enumerator.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/json/json_file_value_serializer.h"
 #include "base/one_shot_event.h"
 #include "base/sequenced_task_runner.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/task/post_task.h"
@@ -49,29 +55,138 @@ using extensions::Manifest;
 namespace {
 
 constexpr char kRunAtDocumentStart[] = "document_start";
+constexpr char kCacheDirName[] = "Cache";
 
-// Wraps a Greaselion rule in a component. The component is stored as
-// an unpacked extension in the user data dir. Returns a valid
-// extension that the caller should take ownership of, or nullptr.
+// Greaselion scripts are not signed, but the public key for an extension
+// doubles as its unique identity, and we need one of those, so we add the
+// rule name to a known Brave domain and hash the result to create a
+// public key.
+std::string GetExtensionPublicKey(const std::string& script_name) {
+  char raw[crypto::kSHA256Length] = {0};
+  std::string key;
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+  if (!command_line.HasSwitch(brave_component_updater::kUseGoUpdateDev) &&
+      !base::FeatureList::IsEnabled(
+          brave_component_updater::kUseDevUpdaterUrl)) {
+    crypto::SHA256HashString(UPDATER_DEV_ENDPOINT + script_name,
+                             raw,
+                             crypto::kSHA256Length);
+  } else {
+    crypto::SHA256HashString(UPDATER_PROD_ENDPOINT + script_name,
+                             raw,
+                             crypto::kSHA256Length);
+  }
+  base::Base64Encode(base::StringPiece(raw, crypto::kSHA256Length), &key);
+  return key;
+}
+
+// Appends |value| to the cache key input |input|, terminated so that
+// consecutive values can't run into each other.
+void AppendCacheKeyInput(const std::string& value, std::string* input) {
+  input->append(value);
+  input->push_back('\0');
+}
+
+// Appends the path and the contents of |file| to the cache key input |input|.
+void AppendCacheKeyFileInput(const base::FilePath& file, std::string* input) {
+  AppendCacheKeyInput(file.AsUTF8Unsafe(), input);
+  std::string contents;
+  if (!base::ReadFileToString(file, &contents))
+    LOG(WARNING) << "Could not read Greaselion file: " << file.value();
+  AppendCacheKeyInput(contents, input);
+}
+
+// Returns the name of the on-disk cache directory for the extension converted
+// from |rule|. Everything that ends up in the converted extension is part of
+// the key, including the contents of its scripts and messages, so that files
+// edited in place (e.g. in dev mode) are converted again. The rule's
+// preconditions are not, since they only decide whether the extension is
+// installed at all. The browser version is included so that an update
+// discards extensions written by an older converter.
+//
+// NOTE: This function does file IO and should not be called on the UI thread.
+std::string GetCacheKeyOnTaskRunner(const greaselion::GreaselionRule& rule,
+                                    const base::Version& browser_version) {
+  std::string input;
+  AppendCacheKeyInput(browser_version.GetString(), &input);
+  AppendCacheKeyInput(GetExtensionPublicKey(rule.name()), &input);
+  AppendCacheKeyInput(rule.name(), &input);
+  AppendCacheKeyInput(rule.run_at(), &input);
+  for (const auto& url_pattern : rule.url_patterns())
+    AppendCacheKeyInput(url_pattern, &input);
+  AppendCacheKeyInput(std::string(), &input);
+  AppendCacheKeyInput(rule.messages().AsUTF8Unsafe(), &input);
+  if (!rule.messages().empty()) {
+    std::vector<base::FilePath> message_files;
+    base::FileEnumerator enumerator(rule.messages(), true,
+                                    base::FileEnumerator::FILES);
+    for (base::FilePath path = enumerator.Next(); !path.empty();
+         path = enumerator.Next()) {
+      message_files.push_back(path);
+    }
+    std::sort(message_files.begin(), message_files.end());
+    for (const auto& message_file : message_files)
+      AppendCacheKeyFileInput(message_file, &input);
+  }
+  AppendCacheKeyInput(std::string(), &input);
+  for (const auto& script : rule.scripts())
+    AppendCacheKeyFileInput(script, &input);
+  const std::string hash = crypto::SHA256HashString(input);
+  return base::ToLowerASCII(base::HexEncode(hash.data(), hash.size()));
+}
+
+// Returns the cache keys of |rules|, in the same order.
 //
 // NOTE: This function does file IO and should not be called on the UI thread.
-// NOTE: The caller takes ownership of the directory at extension->path() on the
-// returned object.
-base::Optional<greaselion::GreaselionServiceImpl::GreaselionConvertedExtension>
-ConvertGreaselionRuleToExtensionOnTaskRunner(
+std::vector<std::string> GetCacheKeysOnTaskRunner(
+    const std::vector<greaselion::GreaselionRule>& rules,
+    const base::Version& browser_version) {
+  std::vector<std::string> cache_keys;
+  cache_keys.reserve(rules.size());
+  for (const auto& rule : rules)
+    cache_keys.push_back(GetCacheKeyOnTaskRunner(rule, browser_version));
+  return cache_keys;
+}
+
+// Loads the unpacked extension for |rule| from the cache directory for
+// |cache_key|, converting the rule first if it hasn't been cached yet (or the
+// cached copy fails to load). Returns nullptr on failure.
+//
+// NOTE: This function does file IO and should not be called on the UI thread.
+scoped_refptr<Extension> LoadOrConvertGreaselionRuleOnTaskRunner(
     const greaselion::GreaselionRule& rule,
+    const std::string& cache_key,
     const base::FilePath& install_dir) {
+  std::string error;
+  base::FilePath cache_dir =
+      install_dir.AppendASCII(kCacheDirName).AppendASCII(cache_key);
+  if (base::DirectoryExists(cache_dir)) {
+    scoped_refptr<Extension> extension = extensions::file_util::LoadExtension(
+        cache_dir, Manifest::COMPONENT, Extension::NO_FLAGS, &error);
+    if (extension)
+      return extension;
+    LOG(WARNING) << "Discarding cached Greaselion extension: " << error;
+    if (!base::DeletePathRecursively(cache_dir)) {
+      LOG(ERROR) << "Could not delete cached Greaselion extension";
+      return nullptr;
+    }
+  }
+
+  // Convert into a temporary directory first and move it into place once it
+  // is complete, so that an interrupted conversion is never picked up from
+  // the cache.
   base::FilePath install_temp_dir =
       extensions::file_util::GetInstallTempDir(install_dir);
   if (install_temp_dir.empty()) {
     LOG(ERROR) << "Could not get path to profile temp directory";
-    return base::nullopt;
+    return nullptr;
   }
 
   base::ScopedTempDir temp_dir;
   if (!temp_dir.CreateUniqueTempDirUnderPath(install_temp_dir)) {
     LOG(ERROR) << "Could not create Greaselion temp directory";
-    return base::nullopt;
+    return nullptr;
   }
 
   // Create the manifest
@@ -81,28 +196,8 @@ ConvertGreaselionRuleToExtensionOnTaskRunner(
   // see kModernManifestVersion in src/extensions/common/extension.cc
   root->SetIntPath(extensions::manifest_keys::kManifestVersion, 2);
 
-  // Create the public key.
-  // Greaselion scripts are not signed, but the public key for an extension
-  // doubles as its unique identity, and we need one of those, so we add the
-  // rule name to a known Brave domain and hash the result to create a
-  // public key.
-  char raw[crypto::kSHA256Length] = {0};
-  std::string key;
   std::string script_name = rule.name();
-  const base::CommandLine& command_line =
-      *base::CommandLine::ForCurrentProcess();
-  if (!command_line.HasSwitch(brave_component_updater::kUseGoUpdateDev) &&
-      !base::FeatureList::IsEnabled(
-          brave_component_updater::kUseDevUpdaterUrl)) {
-    crypto::SHA256HashString(UPDATER_DEV_ENDPOINT + script_name,
-                             raw,
-                             crypto::kSHA256Length);
-  } else {
-    crypto::SHA256HashString(UPDATER_PROD_ENDPOINT + script_name,
-                             raw,
-                             crypto::kSHA256Length);
-  }
-  base::Base64Encode(base::StringPiece(raw, crypto::kSHA256Length), &key);
+  std::string key = GetExtensionPublicKey(script_name);
 
   root->SetStringPath(extensions::manifest_keys::kName, script_name);
   root->SetStringPath(extensions::manifest_keys::kVersion, "1.0");
@@ -149,7 +244,7 @@ ConvertGreaselionRuleToExtensionOnTaskRunner(
   // files to disk.
   if (!serializer.Serialize(*root)) {
     LOG(ERROR) << "Could not write Greaselion manifest";
-    return base::nullopt;
+    return nullptr;
   }
 
   // Copy the messages directory to our extension directory.
@@ -159,7 +254,7 @@ ConvertGreaselionRuleToExtensionOnTaskRunner(
             temp_dir.GetPath().AppendASCII("_locales"), true)) {
       LOG(ERROR) << "Could not copy Greaselion messages directory at path: "
                  << rule.messages().LossyDisplayName();
-      return base::nullopt;
+      return nullptr;
     }
   }
 
@@ -169,22 +264,40 @@ ConvertGreaselionRuleToExtensionOnTaskRunner(
                         temp_dir.GetPath().Append(script.BaseName()))) {
       LOG(ERROR) << "Could not copy Greaselion script at path: "
           << script.LossyDisplayName();
-      return base::nullopt;
+      return nullptr;
     }
   }
 
-  std::string error;
+  if (!base::CreateDirectory(cache_dir.DirName()) ||
+      !base::Move(temp_dir.GetPath(), cache_dir)) {
+    LOG(ERROR) << "Could not move Greaselion extension into the cache";
+    return nullptr;
+  }
+  ignore_result(temp_dir.Take());
+
   scoped_refptr<Extension> extension = extensions::file_util::LoadExtension(
-      temp_dir.GetPath(), Manifest::COMPONENT, Extension::NO_FLAGS, &error);
+      cache_dir, Manifest::COMPONENT, Extension::NO_FLAGS, &error);
   if (!extension.get()) {
     LOG(ERROR) << "Could not load Greaselion extension";
     LOG(ERROR) << error;
-    return base::nullopt;
+    return nullptr;
   }
 
-  // Take ownership of this temporary directory so it's deleted when
-  // the service exits
-  return std::make_pair(extension, std::move(temp_dir));
+  return extension;
+}
+
+// Deletes cached extensions whose key is not in |cache_keys|, which holds the
+// keys of all known rules and of all extensions still loaded from the cache.
+void DeleteStaleCachedExtensionsOnTaskRunner(
+    const base::FilePath& install_dir,
+    const std::set<std::string>& cache_keys) {
+  base::FileEnumerator enumerator(install_dir.AppendASCII(kCacheDirName),
+                                  false, base::FileEnumerator::DIRECTORIES);
+  for (base::FilePath path = enumerator.Next(); !path.empty();
+       path = enumerator.Next()) {
+    if (!base::Contains(cache_keys, path.BaseName().AsUTF8Unsafe()))
+      base::DeletePathRecursively(path);
+  }
 }
 }  // namespace
 
@@ -208,6 +321,7 @@ GreaselionServiceImpl::GreaselionServiceImpl(
       task_runner_(std::move(task_runner)),
       browser_version_(
           version_info::GetBraveVersionWithoutChromiumMajorVersion()),
+      startup_time_(base::TimeTicks::Now()),
       weak_factory_(this) {
   extension_registry_->AddObserver(this);
   for (int i = FIRST_FEATURE; i != LAST_FEATURE; i++)
@@ -221,13 +335,20 @@ GreaselionServiceImpl::~GreaselionServiceImpl() {
 }
 
 bool GreaselionServiceImpl::IsGreaselionExtension(const std::string& id) {
-  return std::find(greaselion_extensions_.begin(), greaselion_extensions_.end(),
-                   id) != greaselion_extensions_.end();
+  for (const auto& installed : installed_extensions_) {
+    if (installed.second == id)
+      return true;
+  }
+  return false;
 }
 
 std::vector<extensions::ExtensionId>
 GreaselionServiceImpl::GetExtensionIdsForTesting() {
-  return greaselion_extensions_;
+  std::vector<extensions::ExtensionId> ids;
+  ids.reserve(installed_extensions_.size());
+  for (const auto& installed : installed_extensions_)
+    ids.push_back(installed.second);
+  return ids;
 }
 
 void GreaselionServiceImpl::UpdateInstalledExtensions() {
@@ -236,74 +357,120 @@ void GreaselionServiceImpl::UpdateInstalledExtensions() {
     return;
   }
   update_in_progress_ = true;
-  if (greaselion_extensions_.empty()) {
-    // No Greaselion extensions are currently installed, so we can move on to
-    // the install phase immediately.
+  update_timer_ = base::ElapsedTimer();
+
+  // Cache keys depend on the contents of the rules' files, so they are
+  // computed on the extension file task runner.
+  std::vector<GreaselionRule> rules;
+  for (const std::unique_ptr<GreaselionRule>& rule :
+       *download_service_->rules()) {
+    if (!rule->has_unknown_preconditions())
+      rules.push_back(*rule);
+  }
+  auto get_cache_keys =
+      base::BindOnce(&GetCacheKeysOnTaskRunner, rules, browser_version_);
+  base::PostTaskAndReplyWithResult(
+      task_runner_.get(), FROM_HERE, std::move(get_cache_keys),
+      base::BindOnce(&GreaselionServiceImpl::OnCacheKeysComputed,
+                     weak_factory_.GetWeakPtr(), std::move(rules)));
+}
+
+void GreaselionServiceImpl::OnCacheKeysComputed(
+    std::vector<GreaselionRule> rules,
+    const std::vector<std::string>& rule_cache_keys) {
+  DCHECK(update_in_progress_);
+  DCHECK_EQ(rules.size(), rule_cache_keys.size());
+
+  // Work out which rules should be installed in the current state, keyed by
+  // the cache key of their converted extension. Rules whose key is already
+  // installed are left alone; only the difference is unloaded and installed.
+  base::flat_map<std::string, GreaselionRule> matching_rules;
+  std::set<std::string> cache_keys;
+  for (size_t i = 0; i < rules.size(); ++i) {
+    cache_keys.insert(rule_cache_keys[i]);
+    if (rules[i].Matches(state_, browser_version_))
+      matching_rules.emplace(rule_cache_keys[i], std::move(rules[i]));
+  }
+
+  // Extensions which are still loaded keep their directory until they are
+  // unloaded, even if their rule changed or went away.
+  for (const auto& installed : installed_extensions_)
+    cache_keys.insert(installed.first);
+  if (cache_keys != cache_keys_) {
+    cache_keys_ = cache_keys;
+    task_runner_->PostTask(
+        FROM_HERE, base::BindOnce(&DeleteStaleCachedExtensionsOnTaskRunner,
+                                  install_directory_, std::move(cache_keys)));
+  }
+
+  rules_to_install_.clear();
+  for (auto& matching_rule : matching_rules) {
+    if (!base::Contains(installed_extensions_, matching_rule.first))
+      rules_to_install_.push_back(std::move(matching_rule));
+  }
+
+  std::vector<extensions::ExtensionId> stale_extensions;
+  for (const auto& installed : installed_extensions_) {
+    if (!base::Contains(matching_rules, installed.first))
+      stale_extensions.push_back(installed.second);
+  }
+  pending_unloads_ = base::flat_set<extensions::ExtensionId>(stale_extensions);
+  if (pending_unloads_.empty()) {
     CreateAndInstallExtensions();
     return;
   }
 
-  // Make a copy of greaselion_extensions_ to iterate while the original vector
-  // changes.
-  std::vector<extensions::ExtensionId> extensions = greaselion_extensions_;
-  for (auto id : extensions) {
-    // We need to unload all the Greaselion extensions that are already
-    // installed. OnExtensionUnloaded will be called on each extension, where we
-    // will update the greaselion_extensions_ set. Once it's empty, that
-    // callback will call CreateAndInstallExtensions().
+  for (const auto& id : stale_extensions) {
+    // OnExtensionUnloaded will be called on each extension, where we will
+    // update pending_unloads_. Once it's empty, that callback will call
+    // CreateAndInstallExtensions(). Installs have to wait for this because a
+    // changed rule keeps its extension id.
     extension_service_->UnloadExtension(
         id, extensions::UnloadedExtensionReason::UPDATE);
   }
 }
 
 void GreaselionServiceImpl::CreateAndInstallExtensions() {
-  DCHECK(greaselion_extensions_.empty());
+  DCHECK(pending_unloads_.empty());
   DCHECK(update_in_progress_);
   all_rules_installed_successfully_ = true;
-  pending_installs_ = 0;
-  std::vector<std::unique_ptr<GreaselionRule>>* rules =
-      download_service_->rules();
-  for (const std::unique_ptr<GreaselionRule>& rule : *rules) {
-    if (rule->Matches(state_, browser_version_) &&
-        rule->has_unknown_preconditions() == false) {
-      pending_installs_ += 1;
-    }
-  }
+  pending_installs_ = static_cast<int>(rules_to_install_.size());
+  VLOG(1) << "Greaselion: installing " << pending_installs_
+          << " extension(s), keeping " << installed_extensions_.size();
   if (!pending_installs_) {
-    // no rules match, nothing else to do
+    // nothing changed, nothing else to do
     MaybeNotifyObservers();
     return;
   }
-  for (const std::unique_ptr<GreaselionRule>& rule : *rules) {
-    if (rule->Matches(state_, browser_version_) &&
-        rule->has_unknown_preconditions() == false) {
-      // Convert script file to component extension. This must run on extension
-      // file task runner, which was passed in in the constructor.
-      GreaselionRule rule_copy(*rule);
-      base::PostTaskAndReplyWithResult(
-          task_runner_.get(), FROM_HERE,
-          base::BindOnce(&ConvertGreaselionRuleToExtensionOnTaskRunner,
-                         rule_copy, install_directory_),
-          base::BindOnce(&GreaselionServiceImpl::PostConvert,
-                         weak_factory_.GetWeakPtr()));
-    }
+  for (auto& rule_to_install : rules_to_install_) {
+    // Load the converted extension from the cache, converting the rule first
+    // if needed. This must run on extension file task runner, which was
+    // passed in in the constructor.
+    base::PostTaskAndReplyWithResult(
+        task_runner_.get(), FROM_HERE,
+        base::BindOnce(&LoadOrConvertGreaselionRuleOnTaskRunner,
+                       std::move(rule_to_install.second),
+                       rule_to_install.first, install_directory_),
+        base::BindOnce(&GreaselionServiceImpl::PostConvert,
+                       weak_factory_.GetWeakPtr(), rule_to_install.first));
   }
+  rules_to_install_.clear();
 }
 
 void GreaselionServiceImpl::PostConvert(
-    base::Optional<GreaselionConvertedExtension> converted_extension) {
-  if (!converted_extension) {
+    const std::string& cache_key,
+    scoped_refptr<extensions::Extension> extension) {
+  if (!extension) {
     all_rules_installed_successfully_ = false;
     pending_installs_ -= 1;
     MaybeNotifyObservers();
     LOG(ERROR) << "Could not load Greaselion script";
   } else {
-    greaselion_extensions_.push_back(converted_extension->first->id());
-    extension_dirs_.push_back(std::move(converted_extension->second));
+    installed_extensions_[cache_key] = extension->id();
     extension_system_->ready().Post(
-        FROM_HERE, base::BindOnce(&GreaselionServiceImpl::Install,
-                                  weak_factory_.GetWeakPtr(),
-                                  std::move(converted_extension->first)));
+        FROM_HERE,
+        base::BindOnce(&GreaselionServiceImpl::Install,
+                       weak_factory_.GetWeakPtr(), std::move(extension)));
   }
 }
 
@@ -315,9 +482,7 @@ void GreaselionServiceImpl::Install(
 void GreaselionServiceImpl::OnExtensionReady(
     content::BrowserContext* browser_context,
     const extensions::Extension* extension) {
-  auto index = std::find(greaselion_extensions_.begin(),
-                         greaselion_extensions_.end(), extension->id());
-  if (index == greaselion_extensions_.end()) {
+  if (!IsGreaselionExtension(extension->id())) {
     // not one of ours
     return;
   }
@@ -330,14 +495,18 @@ void GreaselionServiceImpl::OnExtensionUnloaded(
     content::BrowserContext* browser_context,
     const extensions::Extension* extension,
     extensions::UnloadedExtensionReason reason) {
-  auto index = std::find(greaselion_extensions_.begin(),
-                         greaselion_extensions_.end(), extension->id());
-  if (index == greaselion_extensions_.end()) {
+  auto index = std::find_if(installed_extensions_.begin(),
+                            installed_extensions_.end(),
+                            [extension](const auto& installed) {
+                              return installed.second == extension->id();
+                            });
+  if (index == installed_extensions_.end()) {
     // not one of ours
     return;
   }
-  greaselion_extensions_.erase(index);
-  if (update_in_progress_ && greaselion_extensions_.empty()) {
+  installed_extensions_.erase(index);
+  if (pending_unloads_.erase(extension->id()) && update_in_progress_ &&
+      pending_unloads_.empty()) {
     // It's time!
     CreateAndInstallExtensions();
   }
@@ -354,6 +523,14 @@ void GreaselionServiceImpl::RemoveObserver(Observer* observer) {
 void GreaselionServiceImpl::MaybeNotifyObservers() {
   if (!pending_installs_) {
     update_in_progress_ = false;
+    VLOG(1) << "Greaselion: update took "
+            << update_timer_.Elapsed().InMilliseconds() << " ms";
+    if (!startup_time_.is_null()) {
+      VLOG(1) << "Greaselion: ready "
+              << (base::TimeTicks::Now() - startup_time_).InMilliseconds()
+              << " ms after startup";
+      startup_time_ = base::TimeTicks();
+    }
     if (update_pending_) {
       update_pending_ = false;
       UpdateInstalledExtensions();
@@ -8,16 +8,21 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "base/containers/flat_map.h"
+#include "base/containers/flat_set.h"
 #include "base/files/file_path.h"
-#include "base/files/scoped_temp_dir.h"
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
 #include "base/path_service.h"
+#include "base/time/time.h"
+#include "base/timer/elapsed_timer.h"
 #include "base/version.h"
+#include "brave/components/greaselion/browser/greaselion_download_service.h"
 #include "brave/components/greaselion/browser/greaselion_service.h"
 #include "extensions/common/extension_id.h"
 #include "url/gurl.h"
@@ -35,8 +40,6 @@ class ExtensionSystem;
 
 namespace greaselion {
 
-class GreaselionDownloadService;
-
 class GreaselionServiceImpl : public GreaselionService {
  public:
   explicit GreaselionServiceImpl(
@@ -63,14 +66,13 @@ class GreaselionServiceImpl : public GreaselionService {
                            const extensions::Extension* extension,
                            extensions::UnloadedExtensionReason reason) override;
 
-  using GreaselionConvertedExtension =
-      std::pair<scoped_refptr<extensions::Extension>, base::ScopedTempDir>;
-
  private:
   void SetBrowserVersionForTesting(const base::Version& version) override;
+  void OnCacheKeysComputed(std::vector<GreaselionRule> rules,
+                           const std::vector<std::string>& rule_cache_keys);
   void CreateAndInstallExtensions();
-  void PostConvert(
-      base::Optional<GreaselionConvertedExtension> converted_extension);
+  void PostConvert(const std::string& cache_key,
+                   scoped_refptr<extensions::Extension> extension);
   void Install(scoped_refptr<extensions::Extension> extension);
   void MaybeNotifyObservers();
 
@@ -86,9 +88,17 @@ class GreaselionServiceImpl : public GreaselionService {
   int pending_installs_;
   scoped_refptr<base::SequencedTaskRunner> task_runner_;
   base::ObserverList<Observer> observers_;
-  std::vector<extensions::ExtensionId> greaselion_extensions_;
-  std::vector<base::ScopedTempDir> extension_dirs_;
+  // Installed (or installing) extensions, keyed by the cache key of the rule
+  // they were converted from.
+  base::flat_map<std::string, extensions::ExtensionId> installed_extensions_;
+  std::vector<std::pair<std::string, GreaselionRule>> rules_to_install_;
+  base::flat_set<extensions::ExtensionId> pending_unloads_;
+  // Cache keys of all known rules and loaded extensions, as of the last
+  // cleanup of the on-disk cache.
+  std::set<std::string> cache_keys_;
   base::Version browser_version_;
+  base::TimeTicks startup_time_;
+  base::ElapsedTimer update_timer_;
   base::WeakPtrFactory<GreaselionServiceImpl> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(GreaselionServiceImpl);
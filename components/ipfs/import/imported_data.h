@@ -35,6 +35,8 @@ struct ImportedData {
 
 using ImportCompletedCallback =
     base::OnceCallback<void(const ipfs::ImportedData&)>;
+using ImportProgressCallback =
+    base::RepeatingCallback<void(int64_t uploaded_bytes, int64_t total_bytes)>;
 
 }  // namespace ipfs
 
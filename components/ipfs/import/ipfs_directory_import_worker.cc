@@ -5,7 +5,9 @@
 
 #include "brave/components/ipfs/import/ipfs_directory_import_worker.h"
 
+#include <algorithm>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -13,17 +15,48 @@
 #include "base/files/file_enumerator.h"
 #include "base/files/file_util.h"
 #include "base/guid.h"
+#include "base/json/string_escape.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
 #include "base/task/post_task.h"
 #include "base/task_runner_util.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "brave/components/ipfs/import/import_utils.h"
 #include "brave/components/ipfs/ipfs_constants.h"
+#include "brave/components/ipfs/ipfs_json_parser.h"
 #include "content/public/browser/browser_context.h"
 #include "content/public/browser/browser_thread.h"
 #include "net/base/mime_util.h"
+#include "net/base/net_errors.h"
+#include "net/base/url_util.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_status_code.h"
+#include "services/network/public/cpp/resource_request.h"
+#include "services/network/public/cpp/shared_url_loader_factory.h"
 #include "services/network/public/cpp/simple_url_loader.h"
+#include "storage/browser/blob/blob_data_builder.h"
 
 namespace {
 
 const char kDirectoryMimeType[] = "application/x-directory";
+const char kDirectoryNodeMimeType[] = "application/json";
+// Base64 encoded UnixFS data of a directory node.
+const char kDirectoryNodeData[] = "CAE=";
+
+// Limits for a single /api/v0/add request.
+const size_t kMaxBatchEntries = 1000;
+const int64_t kMaxBatchBytes = 32 * 1024 * 1024;
+const size_t kMaxConcurrentUploads = 2;
+const int kMaxUploadRetries = 3;
+const int kRetryDelaySeconds = 1;
+
+// Doubles the delay with every retry.
+base::TimeDelta GetRetryDelay(int retries) {
+  DCHECK_GT(retries, 0);
+  return base::TimeDelta::FromSeconds(kRetryDelaySeconds << (retries - 1));
+}
 
 bool GetRelativePathComponent(const base::FilePath& parent,
                               const base::FilePath& child,
@@ -50,6 +83,13 @@ bool GetRelativePathComponent(const base::FilePath& parent,
   return true;
 }
 
+std::string GetRelativePath(const base::FilePath& parent,
+                            const base::FilePath& child) {
+  base::FilePath::StringType relative_path;
+  GetRelativePathComponent(parent, child, &relative_path);
+  return base::FilePath(relative_path).MaybeAsASCII();
+}
+
 std::vector<ipfs::ImportFileInfo> EnumberateDirectoryFiles(
     base::FilePath dir_path) {
   std::vector<ipfs::ImportFileInfo> files;
@@ -67,27 +107,77 @@ std::vector<ipfs::ImportFileInfo> EnumberateDirectoryFiles(
   return files;
 }
 
-std::unique_ptr<storage::BlobDataBuilder> BuildBlobWithFolder(
+// Splits the directory into batches of at most |kMaxBatchEntries| entries and
+// |kMaxBatchBytes| bytes, larger files are sent alone. Entries are sorted by
+// path components so that every directory is followed by its content and
+// each batch covers a contiguous part of the tree.
+std::vector<ipfs::ImportBatch> EnumerateDirectoryBatches(
+    base::FilePath dir_path) {
+  std::vector<std::pair<std::vector<base::FilePath::StringType>,
+                        ipfs::ImportFileInfo>>
+      entries;
+  for (auto& info : EnumberateDirectoryFiles(dir_path)) {
+    std::vector<base::FilePath::StringType> components;
+    info.path.GetComponents(&components);
+    entries.emplace_back(std::move(components), std::move(info));
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  std::vector<ipfs::ImportBatch> batches(1);
+  std::vector<ipfs::ImportFileInfo> parents;
+  for (const auto& entry : entries) {
+    const ipfs::ImportFileInfo& info = entry.second;
+    while (!parents.empty() && !parents.back().path.IsParent(info.path))
+      parents.pop_back();
+
+    int64_t size = info.info.IsDirectory() ? 0 : info.info.GetSize();
+    ipfs::ImportBatch* batch = &batches.back();
+    if (!batch->files.empty() &&
+        (batch->files.size() >= kMaxBatchEntries ||
+         batch->size + size > kMaxBatchBytes)) {
+      batches.emplace_back();
+      batch = &batches.back();
+      batch->parents = parents;
+    }
+    batch->files.push_back(info);
+    batch->size += size;
+
+    if (info.info.IsDirectory())
+      parents.push_back(info);
+  }
+
+  return batches;
+}
+
+void AppendEntryToBlob(const base::FilePath& upload_path,
+                       const std::string& mime_boundary,
+                       const ipfs::ImportFileInfo& info,
+                       storage::BlobDataBuilder* blob_builder) {
+  std::string data_header;
+  std::string mime_type =
+      info.info.IsDirectory() ? kDirectoryMimeType : ipfs::kFileMimeType;
+  data_header.append("\r\n");
+  ipfs::AddMultipartHeaderForUploadWithFileName(
+      ipfs::kFileValueName, GetRelativePath(upload_path, info.path),
+      info.path.MaybeAsASCII(), mime_boundary, mime_type, &data_header);
+  blob_builder->AppendData(data_header);
+  if (mime_type == ipfs::kFileMimeType) {
+    blob_builder->AppendFile(info.path, 0, info.info.GetSize(), base::Time());
+  }
+}
+
+std::unique_ptr<storage::BlobDataBuilder> BuildBlobWithBatch(
     base::FilePath upload_path,
     std::string mime_boundary,
-    std::vector<ipfs::ImportFileInfo> files) {
+    ipfs::ImportBatch batch) {
   auto blob_builder =
       std::make_unique<storage::BlobDataBuilder>(base::GenerateGUID());
-  for (const auto& info : files) {
-    std::string data_header;
-    base::FilePath::StringType relative_path;
-    GetRelativePathComponent(upload_path, info.path, &relative_path);
-
-    std::string mime_type =
-        info.info.IsDirectory() ? kDirectoryMimeType : ipfs::kFileMimeType;
-    data_header.append("\r\n");
-    ipfs::AddMultipartHeaderForUploadWithFileName(
-        ipfs::kFileValueName, base::FilePath(relative_path).MaybeAsASCII(),
-        info.path.MaybeAsASCII(), mime_boundary, mime_type, &data_header);
-    blob_builder->AppendData(data_header);
-    if (mime_type == ipfs::kFileMimeType) {
-      blob_builder->AppendFile(info.path, 0, info.info.GetSize(), base::Time());
-    }
+  for (const auto& info : batch.parents) {
+    AppendEntryToBlob(upload_path, mime_boundary, info, blob_builder.get());
+  }
+  for (const auto& info : batch.files) {
+    AppendEntryToBlob(upload_path, mime_boundary, info, blob_builder.get());
   }
 
   std::string post_data_footer = "\r\n";
@@ -97,47 +187,332 @@ std::unique_ptr<storage::BlobDataBuilder> BuildBlobWithFolder(
   return blob_builder;
 }
 
+// Parses the newline delimited objects returned by /api/v0/add.
+bool ParseBatchResponse(const std::string& response_body,
+                        const std::string& filename,
+                        ipfs::ImportBatch* batch) {
+  DCHECK(batch);
+  std::vector<std::string> parts = base::SplitString(
+      response_body, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  for (const auto& item : parts) {
+    if (item.front() != '{' || item.back() != '}')
+      continue;
+    ipfs::ImportedData imported_item;
+    if (!ipfs::IPFSJSONParser::GetImportResponseFromJSON(item, &imported_item))
+      continue;
+    // The wrapping directory has no name and isn't needed.
+    if (imported_item.hash.empty() || imported_item.filename.empty())
+      continue;
+    batch->objects[imported_item.filename] = imported_item;
+  }
+  return batch->objects.count(filename);
+}
+
+// Returns the objects directly inside |directory| keyed by their name.
+std::map<std::string, const ipfs::ImportedData*> GetDirectoryChildren(
+    const std::string& directory,
+    const std::map<std::string, ipfs::ImportedData>& objects) {
+  std::map<std::string, const ipfs::ImportedData*> children;
+  const std::string prefix = directory + "/";
+  for (auto it = objects.lower_bound(prefix);
+       it != objects.end() &&
+       base::StartsWith(it->first, prefix, base::CompareCase::SENSITIVE);
+       ++it) {
+    std::string name = it->first.substr(prefix.size());
+    if (name.find('/') != std::string::npos)
+      continue;
+    children[name] = &it->second;
+  }
+  return children;
+}
+
+// Returns the JSON of a directory node linking to |children|, as accepted by
+// /api/v0/object/put with inputenc=json and datafieldenc=base64.
+std::string GetDirectoryNodeJSON(
+    const std::map<std::string, const ipfs::ImportedData*>& children) {
+  std::vector<std::string> links;
+  for (const auto& child : children) {
+    links.push_back(base::StringPrintf(
+        R"({"Name":%s,"Hash":%s,"Size":%s})",
+        base::GetQuotedJSONString(child.first).c_str(),
+        base::GetQuotedJSONString(child.second->hash).c_str(),
+        base::NumberToString(std::max<int64_t>(child.second->size, 0))
+            .c_str()));
+  }
+  return base::StringPrintf(R"({"Data":"%s","Links":[%s]})",
+                            kDirectoryNodeData,
+                            base::JoinString(links, ",").c_str());
+}
+
+// The cumulative size of a directory is approximated by the sizes of its
+// children, the node itself is small in comparison.
+int64_t GetDirectorySize(
+    const std::map<std::string, const ipfs::ImportedData*>& children) {
+  int64_t size = 0;
+  for (const auto& child : children)
+    size += std::max<int64_t>(child.second->size, 0);
+  return size;
+}
+
+bool IsSuccessfulResponse(network::SimpleURLLoader* url_loader) {
+  int response_code = -1;
+  if (url_loader->ResponseInfo() && url_loader->ResponseInfo()->headers)
+    response_code = url_loader->ResponseInfo()->headers->response_code();
+  return url_loader->NetError() == net::OK && response_code == net::HTTP_OK;
+}
+
 }  // namespace
 
 namespace ipfs {
 
+ImportBatch::ImportBatch() = default;
+ImportBatch::ImportBatch(const ImportBatch& other) = default;
+ImportBatch& ImportBatch::operator=(const ImportBatch& other) = default;
+ImportBatch::~ImportBatch() = default;
+
 IpfsDirectoryImportWorker::IpfsDirectoryImportWorker(
     content::BrowserContext* context,
     const GURL& endpoint,
     ImportCompletedCallback callback,
-    const base::FilePath& source_path)
+    const base::FilePath& source_path,
+    ImportProgressCallback progress_callback)
     : IpfsImportWorkerBase(context, endpoint, std::move(callback)),
       source_path_(source_path),
+      filename_(source_path.BaseName().MaybeAsASCII()),
+      progress_callback_(std::move(progress_callback)),
       file_task_runner_(base::CreateSequencedTaskRunner(
           {base::ThreadPool(), base::MayBlock(),
            base::TaskPriority::BEST_EFFORT,
            base::TaskShutdownBehavior::BLOCK_SHUTDOWN})),
       weak_factory_(this) {
-  std::string mime_boundary = net::GenerateMimeMultipartBoundary();
-  auto blob_builder =
-      std::make_unique<storage::BlobDataBuilder>(base::GenerateGUID());
-
+  SetImportedFilename(filename_);
   base::PostTaskAndReplyWithResult(
       file_task_runner_.get(), FROM_HERE,
-      base::BindOnce(&EnumberateDirectoryFiles, source_path_),
-      base::BindOnce(&IpfsDirectoryImportWorker::CreateRequestWithFolder,
-                     weak_factory_.GetWeakPtr(), mime_boundary));
+      base::BindOnce(&EnumerateDirectoryBatches, source_path_),
+      base::BindOnce(&IpfsDirectoryImportWorker::OnBatchesCreated,
+                     weak_factory_.GetWeakPtr()));
 }
 
 IpfsDirectoryImportWorker::~IpfsDirectoryImportWorker() = default;
 
-void IpfsDirectoryImportWorker::CreateRequestWithFolder(
-    const std::string& mime_boundary,
-    std::vector<ImportFileInfo> files) {
+void IpfsDirectoryImportWorker::OnBatchesCreated(
+    std::vector<ImportBatch> batches) {
+  DCHECK(!batches.empty());
+  batches_ = std::move(batches);
+  for (size_t index = 0; index < batches_.size(); ++index) {
+    total_bytes_ += batches_[index].size;
+    pending_batches_.push(index);
+  }
+  NotifyImportProgress();
+  MaybeUploadBatches();
+}
+
+void IpfsDirectoryImportWorker::MaybeUploadBatches() {
+  while (uploads_in_progress_ < kMaxConcurrentUploads &&
+         !pending_batches_.empty()) {
+    size_t index = pending_batches_.front();
+    pending_batches_.pop();
+    UploadBatch(index);
+  }
+}
+
+void IpfsDirectoryImportWorker::UploadBatch(size_t index) {
+  ++uploads_in_progress_;
+  std::string mime_boundary = net::GenerateMimeMultipartBoundary();
   auto blob_builder_callback =
-      base::BindOnce(&BuildBlobWithFolder, source_path_.DirName(),
-                     mime_boundary, std::move(files));
+      base::BindOnce(&BuildBlobWithBatch, source_path_.DirName(), mime_boundary,
+                     batches_[index]);
 
   std::string content_type = kIPFSImportMultipartContentType;
   content_type += " boundary=";
   content_type += mime_boundary;
-  StartImport(std::move(blob_builder_callback), content_type,
-              source_path_.BaseName().MaybeAsASCII());
+  CreateRequestWithBlob(
+      std::move(blob_builder_callback), content_type,
+      base::BindOnce(&IpfsDirectoryImportWorker::OnBatchRequestCreated,
+                     weak_factory_.GetWeakPtr(), index));
+}
+
+void IpfsDirectoryImportWorker::OnBatchRequestCreated(
+    size_t index,
+    std::unique_ptr<network::ResourceRequest> request) {
+  if (!request)
+    return FailImport(IPFS_IMPORT_ERROR_REQUEST_EMPTY);
+
+  auto url_loader = CreateAddURLLoader(std::move(request));
+  url_loader->SetOnUploadProgressCallback(
+      base::BindRepeating(&IpfsDirectoryImportWorker::OnBatchUploadProgress,
+                          weak_factory_.GetWeakPtr(), index));
+  network::SimpleURLLoader* loader = url_loader.get();
+  url_loaders_[index] = std::move(url_loader);
+  loader->DownloadToStringOfUnboundedSizeUntilCrashAndDie(
+      GetUrlLoaderFactory().get(),
+      base::BindOnce(&IpfsDirectoryImportWorker::OnBatchUploaded,
+                     weak_factory_.GetWeakPtr(), index));
+}
+
+void IpfsDirectoryImportWorker::OnBatchUploadProgress(size_t index,
+                                                      uint64_t position,
+                                                      uint64_t total) {
+  // The request body also contains the multipart headers, so only report the
+  // uploaded share of the file contents.
+  if (!total)
+    return;
+  ImportBatch& batch = batches_[index];
+  batch.uploaded_bytes = static_cast<int64_t>(
+      batch.size * (static_cast<double>(position) / total));
+  NotifyImportProgress();
+}
+
+void IpfsDirectoryImportWorker::OnBatchUploaded(
+    size_t index,
+    std::unique_ptr<std::string> response_body) {
+  auto url_loader = std::move(url_loaders_[index]);
+  url_loaders_.erase(index);
+  --uploads_in_progress_;
+
+  ImportBatch& batch = batches_[index];
+  bool success = IsSuccessfulResponse(url_loader.get()) && response_body &&
+                 ParseBatchResponse(*response_body, filename_, &batch);
+  if (!success) {
+    VLOG(1) << "Failed to add batch " << index << " of " << batches_.size()
+            << " error_code:" << url_loader->NetError();
+    return RetryBatch(index);
+  }
+
+  batch.uploaded_bytes = batch.size;
+  ++uploaded_batches_;
+  NotifyImportProgress();
+  if (uploaded_batches_ == batches_.size())
+    return LinkBatches();
+  MaybeUploadBatches();
+}
+
+void IpfsDirectoryImportWorker::RetryBatch(size_t index) {
+  ImportBatch& batch = batches_[index];
+  if (++batch.retries > kMaxUploadRetries)
+    return FailImport(IPFS_IMPORT_ERROR_ADD_FAILED);
+
+  batch.uploaded_bytes = 0;
+  batch.objects.clear();
+  NotifyImportProgress();
+  base::SequencedTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE,
+      base::BindOnce(&IpfsDirectoryImportWorker::QueueBatch,
+                     weak_factory_.GetWeakPtr(), index),
+      GetRetryDelay(batch.retries));
+  // Other batches may still be waiting.
+  MaybeUploadBatches();
+}
+
+void IpfsDirectoryImportWorker::QueueBatch(size_t index) {
+  pending_batches_.push(index);
+  MaybeUploadBatches();
+}
+
+void IpfsDirectoryImportWorker::NotifyImportProgress() {
+  if (!progress_callback_)
+    return;
+  int64_t uploaded_bytes = 0;
+  for (const auto& batch : batches_)
+    uploaded_bytes += batch.uploaded_bytes;
+  progress_callback_.Run(uploaded_bytes, total_bytes_);
+}
+
+void IpfsDirectoryImportWorker::LinkBatches() {
+  // A directory split across batches is returned by each of them, with only
+  // the entries of that batch.
+  std::set<std::string> split_directories;
+  for (const auto& batch : batches_) {
+    for (const auto& object : batch.objects) {
+      if (!objects_.insert(object).second)
+        split_directories.insert(object.first);
+    }
+  }
+
+  std::vector<std::string> directories(split_directories.begin(),
+                                       split_directories.end());
+  std::stable_sort(directories.begin(), directories.end(),
+                   [](const std::string& a, const std::string& b) {
+                     return std::count(a.begin(), a.end(), '/') >
+                            std::count(b.begin(), b.end(), '/');
+                   });
+  for (const auto& directory : directories)
+    directories_to_link_.push(directory);
+  LinkNextDirectory();
+}
+
+void IpfsDirectoryImportWorker::LinkNextDirectory() {
+  if (directories_to_link_.empty()) {
+    const ImportedData& root = objects_.at(filename_);
+    return MoveToBraveDirectory(root.hash, root.size);
+  }
+
+  const std::string& directory = directories_to_link_.front();
+  std::string mime_boundary = net::GenerateMimeMultipartBoundary();
+  std::string post_data;
+  AddMultipartHeaderForUploadWithFileName(kFileValueName, directory,
+                                          std::string(), mime_boundary,
+                                          kDirectoryNodeMimeType, &post_data);
+  post_data.append(
+      GetDirectoryNodeJSON(GetDirectoryChildren(directory, objects_)));
+  post_data.append("\r\n");
+  net::AddMultipartFinalDelimiterForUpload(mime_boundary, &post_data);
+
+  std::string content_type = kIPFSImportMultipartContentType;
+  content_type += " boundary=";
+  content_type += mime_boundary;
+
+  GURL url = net::AppendQueryParameter(
+      server_endpoint().Resolve(kImportObjectPutPath), "inputenc", "json");
+  url = net::AppendQueryParameter(url, "datafieldenc", "base64");
+
+  DCHECK(!link_url_loader_);
+  link_url_loader_ = CreateURLLoader(url, "POST");
+  link_url_loader_->AttachStringForUpload(post_data, content_type);
+  link_url_loader_->DownloadToStringOfUnboundedSizeUntilCrashAndDie(
+      GetUrlLoaderFactory().get(),
+      base::BindOnce(&IpfsDirectoryImportWorker::OnDirectoryLinked,
+                     weak_factory_.GetWeakPtr()));
+}
+
+void IpfsDirectoryImportWorker::OnDirectoryLinked(
+    std::unique_ptr<std::string> response_body) {
+  auto url_loader = std::move(link_url_loader_);
+  ipfs::ImportedData linked;
+  bool success = IsSuccessfulResponse(url_loader.get()) && response_body &&
+                 IPFSJSONParser::GetImportResponseFromJSON(*response_body,
+                                                           &linked) &&
+                 !linked.hash.empty();
+  if (!success) {
+    VLOG(1) << "Failed to link " << directories_to_link_.front()
+            << " error_code:" << url_loader->NetError();
+    return RetryLinkDirectory();
+  }
+
+  const std::string& directory = directories_to_link_.front();
+  ImportedData& object = objects_[directory];
+  object.hash = linked.hash;
+  object.size = GetDirectorySize(GetDirectoryChildren(directory, objects_));
+  link_retries_ = 0;
+  directories_to_link_.pop();
+  LinkNextDirectory();
+}
+
+void IpfsDirectoryImportWorker::RetryLinkDirectory() {
+  if (++link_retries_ > kMaxUploadRetries)
+    return FailImport(IPFS_IMPORT_ERROR_ADD_FAILED);
+
+  base::SequencedTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE,
+      base::BindOnce(&IpfsDirectoryImportWorker::LinkNextDirectory,
+                     weak_factory_.GetWeakPtr()),
+      GetRetryDelay(link_retries_));
+}
+
+void IpfsDirectoryImportWorker::FailImport(ipfs::ImportState state) {
+  url_loaders_.clear();
+  link_url_loader_.reset();
+  NotifyImportCompleted(state);
 }
 
 }  // namespace ipfs
@@ -6,12 +6,14 @@
 #ifndef BRAVE_COMPONENTS_IPFS_IMPORT_IPFS_DIRECTORY_IMPORT_WORKER_H_
 #define BRAVE_COMPONENTS_IPFS_IMPORT_IPFS_DIRECTORY_IMPORT_WORKER_H_
 
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "base/callback.h"
+#include "base/containers/queue.h"
 #include "base/files/file_enumerator.h"
 #include "base/files/file_util.h"
 #include "base/memory/scoped_refptr.h"
@@ -31,12 +33,37 @@ struct ImportFileInfo {
   base::FileEnumerator::FileInfo info;
 };
 
+// A part of the directory which is added to ipfs with a single request.
+struct ImportBatch {
+  ImportBatch();
+  ImportBatch(const ImportBatch& other);
+  ImportBatch& operator=(const ImportBatch& other);
+  ~ImportBatch();
+
+  // Directories from earlier batches which contain |files|, they are sent
+  // without content so that the daemon recreates the same paths.
+  std::vector<ImportFileInfo> parents;
+  std::vector<ImportFileInfo> files;
+  int64_t size = 0;
+  int64_t uploaded_bytes = 0;
+  int retries = 0;
+  // Objects added by this batch keyed by their path.
+  std::map<std::string, ImportedData> objects;
+};
+
+// Imports the directory in batches of bounded size which are uploaded
+// concurrently and retried separately, with an increasing delay. Each batch
+// is added with wrap-with-directory. Directories whose entries were split
+// across batches are then rebuilt from the objects of all batches with
+// /api/v0/object/put, one request per such directory, deepest first, up to
+// the root of the imported directory.
 class IpfsDirectoryImportWorker : public IpfsImportWorkerBase {
  public:
   IpfsDirectoryImportWorker(content::BrowserContext* context,
                             const GURL& endpoint,
                             ImportCompletedCallback callback,
-                            const base::FilePath& path);
+                            const base::FilePath& path,
+                            ImportProgressCallback progress_callback);
   ~IpfsDirectoryImportWorker() override;
 
   IpfsDirectoryImportWorker(const IpfsDirectoryImportWorker&) = delete;
@@ -44,14 +71,40 @@ class IpfsDirectoryImportWorker : public IpfsImportWorkerBase {
       delete;
 
  private:
-  void OnImportDataAvailable(const base::FilePath path);
+  void OnBatchesCreated(std::vector<ImportBatch> batches);
+  void MaybeUploadBatches();
+  void UploadBatch(size_t index);
+  void OnBatchRequestCreated(size_t index,
+                             std::unique_ptr<network::ResourceRequest> request);
+  void OnBatchUploadProgress(size_t index, uint64_t position, uint64_t total);
+  void OnBatchUploaded(size_t index, std::unique_ptr<std::string> response_body);
+  void RetryBatch(size_t index);
+  void QueueBatch(size_t index);
+  void NotifyImportProgress();
+
+  void LinkBatches();
+  void LinkNextDirectory();
+  void OnDirectoryLinked(std::unique_ptr<std::string> response_body);
+  void RetryLinkDirectory();
 
-  void CreateRequestWithFolder(const std::string& mime_boundary,
-                               std::vector<ImportFileInfo> files);
-  void OnImportAddComplete(std::unique_ptr<std::string> response_body);
+  void FailImport(ipfs::ImportState state);
 
   base::FilePath source_path_;
-  std::unique_ptr<network::SimpleURLLoader> url_loader_;
+  std::string filename_;
+  ImportProgressCallback progress_callback_;
+  std::vector<ImportBatch> batches_;
+  base::queue<size_t> pending_batches_;
+  std::map<size_t, std::unique_ptr<network::SimpleURLLoader>> url_loaders_;
+  size_t uploads_in_progress_ = 0;
+  size_t uploaded_batches_ = 0;
+  int64_t total_bytes_ = 0;
+  // Objects of all batches keyed by their path, directories split across
+  // batches are replaced once they are linked.
+  std::map<std::string, ImportedData> objects_;
+  // Directories split across batches, children before their parents.
+  base::queue<std::string> directories_to_link_;
+  std::unique_ptr<network::SimpleURLLoader> link_url_loader_;
+  int link_retries_ = 0;
   scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
   base::WeakPtrFactory<IpfsDirectoryImportWorker> weak_factory_;
 };
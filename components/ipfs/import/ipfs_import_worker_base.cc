@@ -123,6 +123,16 @@ void IpfsImportWorkerBase::StartImport(
     const std::string& filename) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   data_->filename = filename;
+  CreateRequestWithBlob(std::move(blob_builder_callback), content_type,
+                        base::BindOnce(&IpfsImportWorkerBase::UploadDataUI,
+                                       weak_factory_.GetWeakPtr()));
+}
+
+void IpfsImportWorkerBase::CreateRequestWithBlob(
+    BlobBuilderCallback blob_builder_callback,
+    const std::string& content_type,
+    ResourceRequestCallback callback) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   auto blob_storage_context_getter =
       content::BrowserContext::GetBlobStorageContext(browser_context_);
   base::PostTaskAndReplyWithResult(
@@ -130,8 +140,7 @@ void IpfsImportWorkerBase::StartImport(
       base::BindOnce(&IpfsImportWorkerBase::CreateResourceRequest,
                      base::Unretained(this), std::move(blob_builder_callback),
                      content_type, std::move(blob_storage_context_getter)),
-      base::BindOnce(&IpfsImportWorkerBase::UploadDataUI,
-                     weak_factory_.GetWeakPtr()));
+      std::move(callback));
 }
 
 std::unique_ptr<network::ResourceRequest>
@@ -175,6 +184,18 @@ void IpfsImportWorkerBase::UploadDataUI(
   if (!server_endpoint_.is_valid())
     return NotifyImportCompleted(IPFS_IMPORT_ERROR_ADD_FAILED);
 
+  DCHECK(!url_loader_);
+  url_loader_ = CreateAddURLLoader(std::move(request));
+  url_loader_->DownloadToStringOfUnboundedSizeUntilCrashAndDie(
+      url_loader_factory_.get(),
+      base::BindOnce(&IpfsImportWorkerBase::OnImportAddComplete,
+                     weak_factory_.GetWeakPtr()));
+}
+
+std::unique_ptr<network::SimpleURLLoader>
+IpfsImportWorkerBase::CreateAddURLLoader(
+    std::unique_ptr<network::ResourceRequest> request) {
+  DCHECK(request);
   GURL url = net::AppendQueryParameter(server_endpoint_.Resolve(kImportAddPath),
                                        "stream-channels", "true");
   url = net::AppendQueryParameter(url, "wrap-with-directory", "true");
@@ -190,14 +211,21 @@ void IpfsImportWorkerBase::UploadDataUI(
     origin.pop_back();
   }
   request->headers.SetHeader(net::HttpRequestHeaders::kOrigin, origin);
-  DCHECK(!url_loader_);
-  url_loader_ = network::SimpleURLLoader::Create(
-      std::move(request), GetNetworkTrafficAnnotationTag());
+  return network::SimpleURLLoader::Create(std::move(request),
+                                          GetNetworkTrafficAnnotationTag());
+}
 
-  url_loader_->DownloadToStringOfUnboundedSizeUntilCrashAndDie(
-      url_loader_factory_.get(),
-      base::BindOnce(&IpfsImportWorkerBase::OnImportAddComplete,
-                     weak_factory_.GetWeakPtr()));
+void IpfsImportWorkerBase::SetImportedFilename(const std::string& filename) {
+  data_->filename = filename;
+}
+
+void IpfsImportWorkerBase::MoveToBraveDirectory(const std::string& hash,
+                                                int64_t size) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  DCHECK(!hash.empty());
+  data_->hash = hash;
+  data_->size = size;
+  CreateBraveDirectory();
 }
 
 bool IpfsImportWorkerBase::ParseResponseBody(const std::string& response_body,
@@ -44,7 +44,8 @@ namespace ipfs {
 // Worker:
 //   1. Worker prepares a blob block of data to import
 // IpfsImportWorkerBase:
-//   2. Sends blob to ifps using IPFS api (/api/v0/add)
+//   2. Sends blob to ifps using IPFS api (/api/v0/add), workers may send
+//      several blobs and stitch the results together themselves
 //   3. Creates target directory for import using IPFS api(/api/v0/files/mkdir)
 //   4. Moves objects to target directory using IPFS api(/api/v0/files/cp)
 class IpfsImportWorkerBase {
@@ -58,13 +59,29 @@ class IpfsImportWorkerBase {
   IpfsImportWorkerBase& operator=(const IpfsImportWorkerBase&) = delete;
 
  protected:
+  using ResourceRequestCallback =
+      base::OnceCallback<void(std::unique_ptr<network::ResourceRequest>)>;
+
   void StartImport(BlobBuilderCallback blob_builder_callback,
                    const std::string& content_type,
                    const std::string& filename);
+  // Builds a request with the blob on the IO thread and replies on the UI
+  // thread.
+  void CreateRequestWithBlob(BlobBuilderCallback blob_builder_callback,
+                             const std::string& content_type,
+                             ResourceRequestCallback callback);
   std::unique_ptr<network::SimpleURLLoader> CreateURLLoader(
       const GURL& gurl,
       const std::string& method);
+  // Returns a loader which adds the request body to ipfs (/api/v0/add).
+  std::unique_ptr<network::SimpleURLLoader> CreateAddURLLoader(
+      std::unique_ptr<network::ResourceRequest> request);
+  // For workers which add objects themselves instead of using StartImport.
+  void SetImportedFilename(const std::string& filename);
+  // Continues with steps 3 and 4 for an object added by the worker itself.
+  void MoveToBraveDirectory(const std::string& hash, int64_t size);
   scoped_refptr<network::SharedURLLoaderFactory> GetUrlLoaderFactory();
+  const GURL& server_endpoint() const { return server_endpoint_; }
 
   virtual void NotifyImportCompleted(ipfs::ImportState state);
 
@@ -30,6 +30,7 @@ const char kGarbageCollectionPath[] = "/api/v0/repo/gc";
 const char kImportAddPath[] = "/api/v0/add";
 const char kImportMakeDirectoryPath[] = "/api/v0/files/mkdir";
 const char kImportCopyPath[] = "/api/v0/files/cp";
+const char kImportObjectPutPath[] = "/api/v0/object/put";
 const char kImportDirectory[] = "/brave-imports/";
 const char kIPFSImportMultipartContentType[] = "multipart/form-data;";
 const char kFileValueName[] = "file";
@@ -29,6 +29,7 @@ extern const char kGarbageCollectionPath[];
 extern const char kImportAddPath[];
 extern const char kImportMakeDirectoryPath[];
 extern const char kImportCopyPath[];
+extern const char kImportObjectPutPath[];
 extern const char kImportDirectory[];
 extern const char kIPFSImportMultipartContentType[];
 extern const char kFileValueName[];
@@ -368,8 +368,12 @@ void IpfsService::ImportDirectoryToIpfs(const base::FilePath& folder,
   auto import_completed_callback =
       base::BindOnce(&IpfsService::OnImportFinished, weak_factory_.GetWeakPtr(),
                      std::move(callback), key);
+  auto import_progress_callback =
+      base::BindRepeating(&IpfsService::OnImportProgress,
+                          weak_factory_.GetWeakPtr(), folder);
   importers_[key] = std::make_unique<IpfsDirectoryImportWorker>(
-      context_, server_endpoint_, std::move(import_completed_callback), folder);
+      context_, server_endpoint_, std::move(import_completed_callback), folder,
+      std::move(import_progress_callback));
 }
 
 void IpfsService::ImportTextToIpfs(const std::string& text,
@@ -407,6 +411,14 @@ void IpfsService::OnImportFinished(ipfs::ImportCompletedCallback callback,
   importers_.erase(key);
 }
 
+void IpfsService::OnImportProgress(const base::FilePath& path,
+                                   int64_t uploaded_bytes,
+                                   int64_t total_bytes) {
+  for (auto& observer : observers_) {
+    observer.OnImportProgress(path, uploaded_bytes, total_bytes);
+  }
+}
+
 void IpfsService::GetConnectedPeers(GetConnectedPeersCallback callback,
                                     int retries) {
   if (!IsDaemonLaunched()) {
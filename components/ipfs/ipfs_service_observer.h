@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 
+#include "base/files/file_path.h"
 #include "base/observer_list_types.h"
 #include "components/component_updater/component_updater_service.h"
 
@@ -24,6 +25,10 @@ class IpfsServiceObserver : public base::CheckedObserver {
   virtual void OnInstallationEvent(ComponentUpdaterEvents event) {}
   virtual void OnGetConnectedPeers(bool succes,
                                    const std::vector<std::string>& peers) {}
+  // Reported while a directory is being uploaded to the daemon.
+  virtual void OnImportProgress(const base::FilePath& path,
+                                int64_t uploaded_bytes,
+                                int64_t total_bytes) {}
 };
 
 }  // namespace ipfs
@@ -0,0 +1,121 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/ntp_background_images/browser/ntp_background_images_cache.h"
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/task/post_task.h"
+#include "base/task/thread_pool.h"
+
+namespace ntp_background_images {
+
+namespace {
+
+// Big enough for a few wallpapers plus logos.
+constexpr size_t kMaxCacheSizeInBytes = 20 * 1024 * 1024;
+
+scoped_refptr<base::RefCountedMemory> ReadImageFile(
+    const base::FilePath& path) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return nullptr;
+  // Takes over the string's buffer instead of copying it.
+  return base::RefCountedString::TakeString(&contents);
+}
+
+}  // namespace
+
+NTPBackgroundImagesCache::NTPBackgroundImagesCache()
+    : memory_pressure_listener_(std::make_unique<base::MemoryPressureListener>(
+          FROM_HERE,
+          base::BindRepeating(&NTPBackgroundImagesCache::OnMemoryPressure,
+                              base::Unretained(this)))) {}
+
+NTPBackgroundImagesCache::~NTPBackgroundImagesCache() = default;
+
+void NTPBackgroundImagesCache::GetImage(const base::FilePath& image_file_path,
+                                        GetImageCallback callback) {
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->first != image_file_path)
+      continue;
+    entries_.splice(entries_.begin(), entries_, it);
+    std::move(callback).Run(entries_.front().second);
+    return;
+  }
+
+  auto pending = pending_callbacks_.find(image_file_path);
+  if (pending != pending_callbacks_.end()) {
+    pending->second.push_back(std::move(callback));
+    return;
+  }
+  pending_callbacks_[image_file_path].push_back(std::move(callback));
+  ReadImage(image_file_path);
+}
+
+void NTPBackgroundImagesCache::Prefetch(const base::FilePath& image_file_path) {
+  GetImage(image_file_path, base::DoNothing());
+}
+
+void NTPBackgroundImagesCache::Clear() {
+  ++generation_;
+  entries_.clear();
+  size_in_bytes_ = 0;
+}
+
+void NTPBackgroundImagesCache::ReadImage(
+    const base::FilePath& image_file_path) {
+  base::PostTaskAndReplyWithResult(
+      FROM_HERE, {base::ThreadPool(), base::MayBlock()},
+      base::BindOnce(&ReadImageFile, image_file_path),
+      base::BindOnce(&NTPBackgroundImagesCache::OnReadImage,
+                     weak_factory_.GetWeakPtr(), image_file_path,
+                     generation_));
+}
+
+void NTPBackgroundImagesCache::OnReadImage(
+    const base::FilePath& image_file_path,
+    uint64_t generation,
+    scoped_refptr<base::RefCountedMemory> data) {
+  if (data) {
+    bytes_read_ += data->size();
+    if (generation == generation_)
+      Put(image_file_path, data);
+  }
+
+  auto pending = pending_callbacks_.find(image_file_path);
+  if (pending == pending_callbacks_.end())
+    return;
+  std::vector<GetImageCallback> callbacks = std::move(pending->second);
+  pending_callbacks_.erase(pending);
+  for (auto& callback : callbacks)
+    std::move(callback).Run(data);
+}
+
+void NTPBackgroundImagesCache::Put(const base::FilePath& image_file_path,
+                                   scoped_refptr<base::RefCountedMemory> data) {
+  if (data->size() > kMaxCacheSizeInBytes)
+    return;
+
+  size_in_bytes_ += data->size();
+  entries_.emplace_front(image_file_path, std::move(data));
+  while (size_in_bytes_ > kMaxCacheSizeInBytes) {
+    size_in_bytes_ -= entries_.back().second->size();
+    entries_.pop_back();
+  }
+}
+
+void NTPBackgroundImagesCache::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+  if (memory_pressure_level ==
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE) {
+    return;
+  }
+  Clear();
+}
+
+}  // namespace ntp_background_images
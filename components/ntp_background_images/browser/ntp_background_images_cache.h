@@ -0,0 +1,82 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_NTP_BACKGROUND_IMAGES_BROWSER_NTP_BACKGROUND_IMAGES_CACHE_H_
+#define BRAVE_COMPONENTS_NTP_BACKGROUND_IMAGES_BROWSER_NTP_BACKGROUND_IMAGES_CACHE_H_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/gtest_prod_util.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/weak_ptr.h"
+
+namespace ntp_background_images {
+
+// Keeps recently used image files of the NTP background images components in
+// memory, so that opening several new tabs doesn't read and copy the same
+// multi-MB wallpaper for each of them. Data read from disk is handed out
+// without being copied again. The cache is bounded by size and is dropped on
+// memory pressure.
+class NTPBackgroundImagesCache {
+ public:
+  using GetImageCallback =
+      base::OnceCallback<void(scoped_refptr<base::RefCountedMemory>)>;
+
+  NTPBackgroundImagesCache();
+  ~NTPBackgroundImagesCache();
+
+  NTPBackgroundImagesCache(const NTPBackgroundImagesCache&) = delete;
+  NTPBackgroundImagesCache& operator=(const NTPBackgroundImagesCache&) = delete;
+
+  // Runs |callback| with the content of |image_file_path|. It runs
+  // synchronously when the image is cached, otherwise after the file is read.
+  // Null is passed when the file can't be read.
+  void GetImage(const base::FilePath& image_file_path,
+                GetImageCallback callback);
+  // Reads |image_file_path| into the cache ahead of its first use.
+  void Prefetch(const base::FilePath& image_file_path);
+  // Drops all cached images, e.g. when the component is updated.
+  void Clear();
+
+  size_t size_in_bytes() const { return size_in_bytes_; }
+  // Number of bytes read from disk so far.
+  size_t bytes_read() const { return bytes_read_; }
+
+ private:
+  FRIEND_TEST_ALL_PREFIXES(NTPBackgroundImagesCacheTest, MemoryPressure);
+
+  using Entry =
+      std::pair<base::FilePath, scoped_refptr<base::RefCountedMemory>>;
+
+  void ReadImage(const base::FilePath& image_file_path);
+  void OnReadImage(const base::FilePath& image_file_path,
+                   uint64_t generation,
+                   scoped_refptr<base::RefCountedMemory> data);
+  void Put(const base::FilePath& image_file_path,
+           scoped_refptr<base::RefCountedMemory> data);
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level);
+
+  // Most recently used first.
+  std::list<Entry> entries_;
+  size_t size_in_bytes_ = 0;
+  size_t bytes_read_ = 0;
+  std::map<base::FilePath, std::vector<GetImageCallback>> pending_callbacks_;
+  // Bumped by Clear() so that reads started before it are not cached.
+  uint64_t generation_ = 0;
+  std::unique_ptr<base::MemoryPressureListener> memory_pressure_listener_;
+  base::WeakPtrFactory<NTPBackgroundImagesCache> weak_factory_{this};
+};
+
+}  // namespace ntp_background_images
+
+#endif  // BRAVE_COMPONENTS_NTP_BACKGROUND_IMAGES_BROWSER_NTP_BACKGROUND_IMAGES_CACHE_H_
@@ -0,0 +1,133 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/ntp_background_images/browser/ntp_background_images_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/logging.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/run_loop.h"
+#include "base/test/task_environment.h"
+#include "base/timer/elapsed_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace ntp_background_images {
+
+class NTPBackgroundImagesCacheTest : public testing::Test {
+ public:
+  NTPBackgroundImagesCacheTest() = default;
+  ~NTPBackgroundImagesCacheTest() override = default;
+
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    wallpaper_path_ = temp_dir_.GetPath().AppendASCII("background-1.jpg");
+    // Same order of size as a real wallpaper.
+    wallpaper_data_ = std::string(4 * 1024 * 1024, 'x');
+    ASSERT_TRUE(base::WriteFile(wallpaper_path_, wallpaper_data_));
+  }
+
+  scoped_refptr<base::RefCountedMemory> GetImage(
+      const base::FilePath& path) {
+    scoped_refptr<base::RefCountedMemory> result;
+    base::RunLoop run_loop;
+    cache_.GetImage(path, base::BindOnce(
+                              [](scoped_refptr<base::RefCountedMemory>* result,
+                                 base::OnceClosure quit,
+                                 scoped_refptr<base::RefCountedMemory> data) {
+                                *result = data;
+                                std::move(quit).Run();
+                              },
+                              &result, run_loop.QuitClosure()));
+    run_loop.Run();
+    return result;
+  }
+
+ protected:
+  base::test::TaskEnvironment task_environment_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath wallpaper_path_;
+  std::string wallpaper_data_;
+  NTPBackgroundImagesCache cache_;
+};
+
+TEST_F(NTPBackgroundImagesCacheTest, ReadsOncePerImage) {
+  // Ten NTPs opened in a row showing the same wallpaper.
+  std::vector<scoped_refptr<base::RefCountedMemory>> results;
+  for (int i = 0; i < 10; ++i) {
+    base::ElapsedTimer timer;
+    results.push_back(GetImage(wallpaper_path_));
+    VLOG(1) << "NTP #" << i << " background ready in "
+            << timer.Elapsed().InMicroseconds() << "us";
+  }
+
+  ASSERT_TRUE(results.front());
+  EXPECT_EQ(std::string(results.front()->front_as<char>(),
+                        results.front()->size()),
+            wallpaper_data_);
+  // Every tab gets the same buffer, nothing is copied per tab.
+  for (const auto& result : results)
+    EXPECT_EQ(result.get(), results.front().get());
+  EXPECT_EQ(cache_.bytes_read(), wallpaper_data_.size());
+  EXPECT_EQ(cache_.size_in_bytes(), wallpaper_data_.size());
+}
+
+TEST_F(NTPBackgroundImagesCacheTest, Prefetch) {
+  cache_.Prefetch(wallpaper_path_);
+  // Requests made while prefetching share the same read.
+  auto data = GetImage(wallpaper_path_);
+  ASSERT_TRUE(data);
+  EXPECT_EQ(cache_.bytes_read(), wallpaper_data_.size());
+
+  // Next request is served synchronously.
+  bool called = false;
+  cache_.GetImage(wallpaper_path_,
+                  base::BindOnce(
+                      [](bool* called, scoped_refptr<base::RefCountedMemory>
+                                           data) { *called = !!data; },
+                      &called));
+  EXPECT_TRUE(called);
+}
+
+TEST_F(NTPBackgroundImagesCacheTest, MissingFile) {
+  EXPECT_FALSE(GetImage(temp_dir_.GetPath().AppendASCII("missing.jpg")));
+  EXPECT_EQ(cache_.size_in_bytes(), 0u);
+}
+
+TEST_F(NTPBackgroundImagesCacheTest, Clear) {
+  ASSERT_TRUE(GetImage(wallpaper_path_));
+  cache_.Clear();
+  EXPECT_EQ(cache_.size_in_bytes(), 0u);
+
+  // Component update replaced the file.
+  ASSERT_TRUE(base::WriteFile(wallpaper_path_, "updated"));
+  auto data = GetImage(wallpaper_path_);
+  ASSERT_TRUE(data);
+  EXPECT_EQ(std::string(data->front_as<char>(), data->size()), "updated");
+}
+
+TEST_F(NTPBackgroundImagesCacheTest, MemoryPressure) {
+  ASSERT_TRUE(GetImage(wallpaper_path_));
+  cache_.OnMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE);
+  EXPECT_EQ(cache_.size_in_bytes(), 0u);
+}
+
+TEST_F(NTPBackgroundImagesCacheTest, Bounded) {
+  for (int i = 0; i < 10; ++i) {
+    const base::FilePath path =
+        temp_dir_.GetPath().AppendASCII("background-" + std::to_string(i));
+    ASSERT_TRUE(base::WriteFile(path, wallpaper_data_));
+    ASSERT_TRUE(GetImage(path));
+  }
+  EXPECT_LE(cache_.size_in_bytes(), 20u * 1024 * 1024);
+  EXPECT_GT(cache_.size_in_bytes(), 0u);
+}
+
+}  // namespace ntp_background_images
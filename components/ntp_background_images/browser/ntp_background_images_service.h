@@ -27,6 +27,7 @@ class PrefService;
 
 namespace ntp_background_images {
 
+class NTPBackgroundImagesCache;
 struct NTPBackgroundImagesData;
 
 class NTPBackgroundImagesService {
@@ -68,6 +69,9 @@ class NTPBackgroundImagesService {
 
   std::vector<std::string> GetTopSitesFaviconList() const;
 
+  // In-memory cache of image files of the installed components.
+  NTPBackgroundImagesCache* image_cache() { return image_cache_.get(); }
+
  private:
   friend class TestNTPBackgroundImagesService;
   friend class NTPBackgroundImagesServiceTest;
@@ -141,6 +145,7 @@ class NTPBackgroundImagesService {
   base::ObserverList<Observer>::Unchecked observer_list_;
   std::unique_ptr<NTPBackgroundImagesData> si_images_data_;
   std::unique_ptr<NTPBackgroundImagesData> sr_images_data_;
+  std::unique_ptr<NTPBackgroundImagesCache> image_cache_;
   PrefChangeRegistrar pref_change_registrar_;
   // This is only used for registration during initial(first) SR component
   // download. After initial download is done, it's cached to
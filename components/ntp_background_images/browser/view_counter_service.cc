@@ -19,6 +19,7 @@
 #include "brave/components/brave_referrals/buildflags/buildflags.h"
 #include "brave/components/brave_rewards/common/pref_names.h"
 #include "brave/components/ntp_background_images/browser/features.h"
+#include "brave/components/ntp_background_images/browser/ntp_background_images_cache.h"
 #include "brave/components/ntp_background_images/browser/ntp_background_images_data.h"
 #include "brave/components/ntp_background_images/browser/url_constants.h"
 #include "brave/components/ntp_background_images/common/pref_names.h"
@@ -176,6 +177,7 @@ void ViewCounterService::OnUpdated(NTPBackgroundImagesData* data) {
     model_.ResetCurrentWallpaperImageIndex();
     model_.set_total_image_count(data->backgrounds.size());
     model_.set_ignore_count_to_branded_wallpaper(data->IsSuperReferral());
+    PrefetchNextWallpaper();
   }
 }
 
@@ -217,9 +219,22 @@ void ViewCounterService::RegisterPageView() {
   // or the user opt-in status changing.
   if (IsBrandedWallpaperActive()) {
     model_.RegisterPageView();
+    PrefetchNextWallpaper();
   }
 }
 
+void ViewCounterService::PrefetchNextWallpaper() {
+  if (!IsBrandedWallpaperActive())
+    return;
+
+  auto* data = GetCurrentBrandedWallpaperData();
+  const size_t index = model_.current_wallpaper_image_index();
+  if (!data || index >= data->backgrounds.size())
+    return;
+
+  service_->image_cache()->Prefetch(data->backgrounds[index].image_file);
+}
+
 void ViewCounterService::BrandedWallpaperLogoClicked(
     const std::string& creative_instance_id,
     const std::string& destination_url,
@@ -120,6 +120,10 @@ class ViewCounterService : public KeyedService,
 
   void ResetModel();
 
+  // Loads the wallpaper which is going to be shown next into the image cache
+  // so the next NTP doesn't wait for disk I/O.
+  void PrefetchNextWallpaper();
+
   void UpdateP3AValues() const;
 
   NTPBackgroundImagesService* service_ = nullptr;  // not owned
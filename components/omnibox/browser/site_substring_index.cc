@@ -0,0 +1,77 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/omnibox/browser/site_substring_index.h"
+
+namespace {
+
+// Texts of up to this length are looked up directly, longer ones are
+// narrowed down with their rarest n-gram of this length.
+constexpr size_t kMaxGramLength = 3;
+
+}  // namespace
+
+SiteSubstringIndex::SiteSubstringIndex(const std::vector<std::string>& sites)
+    : sites_(sites) {
+  for (size_t i = 0; i < sites_.size(); ++i) {
+    all_sites_.push_back(i);
+
+    const std::string& site = sites_[i];
+    for (size_t length = 1; length <= kMaxGramLength; ++length) {
+      for (size_t start = 0; start + length <= site.length(); ++start) {
+        std::vector<size_t>& postings = postings_[site.substr(start, length)];
+        // Sites are indexed in order, so a repeated n-gram of the same site
+        // is always last.
+        if (postings.empty() || postings.back() != i)
+          postings.push_back(i);
+      }
+    }
+  }
+}
+
+SiteSubstringIndex::~SiteSubstringIndex() = default;
+
+std::vector<SiteSubstringIndex::Match> SiteSubstringIndex::Find(
+    const std::string& text,
+    size_t max_matches) const {
+  std::vector<Match> matches;
+  const std::vector<size_t>* candidates = FindCandidates(text);
+  if (!candidates)
+    return matches;
+
+  for (size_t index : *candidates) {
+    if (matches.size() >= max_matches)
+      break;
+
+    const size_t position = sites_[index].find(text);
+    if (position != std::string::npos)
+      matches.push_back({index, position});
+  }
+  return matches;
+}
+
+const std::vector<size_t>* SiteSubstringIndex::FindCandidates(
+    const std::string& text) const {
+  if (text.empty())
+    return &all_sites_;
+
+  if (text.length() <= kMaxGramLength) {
+    auto it = postings_.find(text);
+    return it == postings_.end() ? nullptr : &it->second;
+  }
+
+  // Every site containing |text| contains all of its n-grams, so the sites
+  // with the rarest one are enough to check.
+  const std::vector<size_t>* candidates = nullptr;
+  for (size_t start = 0; start + kMaxGramLength <= text.length(); ++start) {
+    auto it = postings_.find(text.substr(start, kMaxGramLength));
+    if (it == postings_.end())
+      return nullptr;
+
+    if (!candidates || it->second.size() < candidates->size())
+      candidates = &it->second;
+  }
+  return candidates;
+}
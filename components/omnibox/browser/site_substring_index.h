@@ -0,0 +1,50 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_OMNIBOX_BROWSER_SITE_SUBSTRING_INDEX_H_
+#define BRAVE_COMPONENTS_OMNIBOX_BROWSER_SITE_SUBSTRING_INDEX_H_
+
+#include <stddef.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+
+// Index of the n-grams of a static list of sites, so that the sites
+// containing the text typed in the omnibox can be found without scanning the
+// whole list on every keystroke.
+class SiteSubstringIndex {
+ public:
+  struct Match {
+    size_t index;     // Index of the site in the indexed list.
+    size_t position;  // Position of the first occurrence of the text.
+  };
+
+  explicit SiteSubstringIndex(const std::vector<std::string>& sites);
+  ~SiteSubstringIndex();
+
+  // Returns the sites containing |text| in list order, i.e. the same sites a
+  // scan of the list with |std::string::find| would, stopping after
+  // |max_matches|.
+  std::vector<Match> Find(const std::string& text, size_t max_matches) const;
+
+ private:
+  // Returns the indexes of the sites that may contain |text| in ascending
+  // order, or null if no site does.
+  const std::vector<size_t>* FindCandidates(const std::string& text) const;
+
+  std::vector<std::string> sites_;
+  std::vector<size_t> all_sites_;
+
+  // Indexes of the sites containing each n-gram of up to |kMaxGramLength|
+  // characters, in ascending order.
+  std::map<std::string, std::vector<size_t>> postings_;
+
+  DISALLOW_COPY_AND_ASSIGN(SiteSubstringIndex);
+};
+
+#endif  // BRAVE_COMPONENTS_OMNIBOX_BROWSER_SITE_SUBSTRING_INDEX_H_
@@ -17,6 +17,7 @@
 #include "components/omnibox/browser/autocomplete_provider.h"
 
 class AutocompleteProviderClient;
+class SiteSubstringIndex;
 
 // This is the provider for Brave Suggested Sites
 class SuggestedSitesProvider : public AutocompleteProvider {
@@ -27,11 +28,16 @@ class SuggestedSitesProvider : public AutocompleteProvider {
   void Start(const AutocompleteInput& input, bool minimal_changes) override;
 
  private:
+  friend class SuggestedSitesProviderTest;
+
   ~SuggestedSitesProvider() override;
 
   static const int kRelevance;
 
   const std::vector<SuggestedSitesMatch>& GetSuggestedSites();
+  // Returns the index of the match strings of |GetSuggestedSites()|, which is
+  // built on first use.
+  const SiteSubstringIndex& GetSuggestedSitesIndex();
   void AddMatch(const SuggestedSitesMatch& match,
                 const ACMatchClassifications& styles);
 
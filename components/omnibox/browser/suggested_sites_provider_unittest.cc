@@ -5,6 +5,10 @@
 
 #include "brave/components/omnibox/browser/suggested_sites_provider.h"
 
+#include <string>
+#include <vector>
+
+#include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "brave/common/pref_names.h"
 #include "brave/components/omnibox/browser/fake_autocomplete_provider_client.h"
@@ -12,6 +16,8 @@
 #include "components/prefs/testing_pref_service.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+// npm run test -- brave_unit_tests --filter=SuggestedSitesProviderTest.*
+
 class SuggestedSitesProviderTest : public testing::Test {
  public:
   SuggestedSitesProviderTest() :
@@ -29,6 +35,24 @@ class SuggestedSitesProviderTest : public testing::Test {
     return client_.GetPrefs();
   }
 
+  // Returns the suggested sites matching |text| by scanning the whole list, as
+  // the provider did before the list was indexed.
+  std::vector<SuggestedSitesMatch> FindByScan(const std::string& text) {
+    std::vector<SuggestedSitesMatch> suggested_sites;
+    for (const auto& match : provider_->GetSuggestedSites()) {
+      if (text.length() < 4 && match.match_string_.length() != text.length())
+        continue;
+      if (match.match_string_.find(text) == 0)
+        suggested_sites.push_back(match);
+    }
+    return suggested_sites;
+  }
+
+  ACMatchClassifications StylesForSingleMatch(const std::string& text,
+                                              const std::string& site) {
+    return SuggestedSitesProvider::StylesForSingleMatch(text, site);
+  }
+
  protected:
   TestSchemeClassifier classifier_;
   FakeAutocompleteProviderClient client_;
@@ -79,3 +103,41 @@ TEST_F(SuggestedSitesProviderTest, NoMatchingWhenPrefIsOff) {
   provider_->Start(CreateAutocompleteInput("bitc"), false);
   EXPECT_TRUE(provider_->matches().empty());
 }
+
+TEST_F(SuggestedSitesProviderTest, MatchesScanForTypedInputs) {
+  const char* const kTypingCorpus[] = {"bitcoin", "ethereum", "litecoin",
+                                       "binance", "BNB",      "ltc",
+                                       "eth",     "coin",     "xyzzy"};
+
+  for (const char* word : kTypingCorpus) {
+    const std::string typed = word;
+    for (size_t length = 1; length <= typed.length(); ++length) {
+      const std::string input = typed.substr(0, length);
+      SCOPED_TRACE(input);
+      const std::string text = base::ToLowerASCII(input);
+      const std::vector<SuggestedSitesMatch> expected_matches =
+          FindByScan(text);
+
+      provider_->Start(CreateAutocompleteInput(input), false);
+      const ACMatches& matches = provider_->matches();
+      ASSERT_EQ(expected_matches.size(), matches.size());
+
+      for (size_t i = 0; i < matches.size(); ++i) {
+        EXPECT_EQ(expected_matches[i].display_, matches[i].contents);
+        EXPECT_EQ(expected_matches[i].destination_url_,
+                  matches[i].destination_url);
+        EXPECT_EQ(static_cast<int>(100 + i), matches[i].relevance);
+
+        const ACMatchClassifications expected_styles = StylesForSingleMatch(
+            text, base::UTF16ToASCII(expected_matches[i].display_));
+        ASSERT_EQ(expected_styles.size(), matches[i].contents_class.size());
+        for (size_t j = 0; j < expected_styles.size(); ++j) {
+          EXPECT_EQ(expected_styles[j].offset,
+                    matches[i].contents_class[j].offset);
+          EXPECT_EQ(expected_styles[j].style,
+                    matches[i].contents_class[j].style);
+        }
+      }
+    }
+  }
+}
@@ -16,6 +16,7 @@
 #include "components/omnibox/browser/autocomplete_provider.h"
 
 class AutocompleteProviderClient;
+class SiteSubstringIndex;
 
 // This is the provider for top Alexa 500 sites URLs
 class TopSitesProvider : public AutocompleteProvider {
@@ -26,12 +27,17 @@ class TopSitesProvider : public AutocompleteProvider {
   void Start(const AutocompleteInput& input, bool minimal_changes) override;
 
  private:
+  friend class TopSitesProviderTest;
+
   ~TopSitesProvider() override;
 
   static const int kRelevance;
 
   static std::vector<std::string> top_sites_;
 
+  // Returns the index of |top_sites_|, which is built on first use.
+  static const SiteSubstringIndex& GetTopSitesIndex();
+
   void AddMatch(const base::string16& match_string,
                 const ACMatchClassifications& styles);
 
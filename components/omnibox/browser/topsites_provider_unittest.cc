@@ -5,7 +5,12 @@
 
 #include "brave/components/omnibox/browser/topsites_provider.h"
 
+#include <string>
+#include <vector>
+
+#include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/timer/elapsed_timer.h"
 #include "brave/common/pref_names.h"
 #include "brave/components/omnibox/browser/fake_autocomplete_provider_client.h"
 #include "components/omnibox/browser/mock_autocomplete_provider_client.h"
@@ -13,6 +18,28 @@
 #include "components/prefs/testing_pref_service.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+// npm run test -- brave_unit_tests --filter=TopSitesProviderTest.*
+
+namespace {
+
+// Words typed one character at a time, as when typing in the omnibox
+const char* const kTypingCorpus[] = {
+    "facebook", "wikipedia", "amazon",  "github", "google.com",
+    "bitcoin",  "ethereum",  "netflix", "reddit", "twitter",
+    "yahoo",    "dex",       "news",    "xyzzy",  "BRAVE"};
+
+std::vector<std::string> GetTypedInputs() {
+  std::vector<std::string> inputs;
+  for (const char* word : kTypingCorpus) {
+    const std::string text = word;
+    for (size_t length = 1; length <= text.length(); ++length)
+      inputs.push_back(text.substr(0, length));
+  }
+  return inputs;
+}
+
+}  // namespace
+
 class TopSitesProviderTest : public testing::Test {
  public:
   TopSitesProviderTest() : provider_(new TopSitesProvider(&client_)) {
@@ -29,6 +56,34 @@ class TopSitesProviderTest : public testing::Test {
     return client_.GetPrefs();
   }
 
+  // Returns the sites matching |text| by scanning the whole list, as the
+  // provider did before the list was indexed.
+  std::vector<std::string> FindByScan(const std::string& text) {
+    std::vector<std::string> sites;
+    for (const auto& site : TopSitesProvider::top_sites_) {
+      if (sites.size() >= provider_->provider_max_matches())
+        break;
+      if (site.find(text) != std::string::npos)
+        sites.push_back(site);
+    }
+    return sites;
+  }
+
+  std::vector<std::string> FindByIndex(const std::string& text) {
+    std::vector<std::string> sites;
+    for (const auto& found : TopSitesProvider::GetTopSitesIndex().Find(
+             text, provider_->provider_max_matches())) {
+      sites.push_back(TopSitesProvider::top_sites_[found.index]);
+    }
+    return sites;
+  }
+
+  ACMatchClassifications StylesForSingleMatch(const std::string& text,
+                                              const std::string& site) {
+    return TopSitesProvider::StylesForSingleMatch(text, site,
+                                                  site.find(text));
+  }
+
  protected:
   TestSchemeClassifier classifier_;
   FakeAutocompleteProviderClient client_;
@@ -56,3 +111,64 @@ TEST_F(TopSitesProviderTest, NoMatchingWhenPrefIsOff) {
   provider_->Start(CreateAutocompleteInput("dex"), false);
   EXPECT_TRUE(provider_->matches().empty());
 }
+
+TEST_F(TopSitesProviderTest, MatchesScanForTypedInputs) {
+  for (const auto& input : GetTypedInputs()) {
+    SCOPED_TRACE(input);
+    const std::string text = base::ToLowerASCII(input);
+    const std::vector<std::string> expected_sites = FindByScan(text);
+
+    provider_->Start(CreateAutocompleteInput(input), false);
+    const ACMatches& matches = provider_->matches();
+    ASSERT_EQ(expected_sites.size(), matches.size());
+
+    for (size_t i = 0; i < matches.size(); ++i) {
+      EXPECT_EQ(base::ASCIIToUTF16(expected_sites[i]), matches[i].contents);
+      EXPECT_EQ(static_cast<int>(100 + matches.size() - (i + 1)),
+                matches[i].relevance);
+
+      const ACMatchClassifications expected_styles =
+          StylesForSingleMatch(text, expected_sites[i]);
+      ASSERT_EQ(expected_styles.size(), matches[i].contents_class.size());
+      for (size_t j = 0; j < expected_styles.size(); ++j) {
+        EXPECT_EQ(expected_styles[j].offset,
+                  matches[i].contents_class[j].offset);
+        EXPECT_EQ(expected_styles[j].style,
+                  matches[i].contents_class[j].style);
+      }
+    }
+  }
+}
+
+TEST_F(TopSitesProviderTest, BenchmarkKeystrokes) {
+  const int kIterations = 100;
+
+  std::vector<std::string> texts;
+  for (const auto& input : GetTypedInputs())
+    texts.push_back(base::ToLowerASCII(input));
+
+  // Build the index before timing, as it is only built once
+  FindByIndex("");
+
+  base::ElapsedTimer scan_timer;
+  size_t scan_count = 0;
+  for (int i = 0; i < kIterations; ++i) {
+    for (const auto& text : texts)
+      scan_count += FindByScan(text).size();
+  }
+  const base::TimeDelta scan_time = scan_timer.Elapsed();
+
+  base::ElapsedTimer index_timer;
+  size_t index_count = 0;
+  for (int i = 0; i < kIterations; ++i) {
+    for (const auto& text : texts)
+      index_count += FindByIndex(text).size();
+  }
+  const base::TimeDelta index_time = index_timer.Elapsed();
+
+  EXPECT_EQ(scan_count, index_count);
+
+  VLOG(1) << kIterations * texts.size() << " keystrokes: "
+          << scan_time.InMicroseconds() << "us scanning the top sites, "
+          << index_time.InMicroseconds() << "us with the index";
+}
@@ -0,0 +1,65 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/p3a/brave_p3a_histogram_buffer.h"
+
+#include <limits>
+
+#include "base/logging.h"
+
+namespace brave {
+
+namespace {
+
+// Marks a histogram without a bucket set since the buckets were last taken.
+constexpr uint64_t kNoBucket = std::numeric_limits<uint64_t>::max();
+
+}  // namespace
+
+BraveP3AHistogramBuffer::BraveP3AHistogramBuffer(
+    const std::vector<base::StringPiece>& histogram_names)
+    : buckets_(new std::atomic<uint64_t>[histogram_names.size()]),
+      take_scheduled_(false) {
+  for (size_t i = 0; i < histogram_names.size(); i++) {
+    indexes_[histogram_names[i]] = i;
+    buckets_[i].store(kNoBucket);
+  }
+}
+
+BraveP3AHistogramBuffer::~BraveP3AHistogramBuffer() = default;
+
+bool BraveP3AHistogramBuffer::SetBucket(base::StringPiece histogram_name,
+                                        uint64_t bucket) {
+  DCHECK_NE(kNoBucket, bucket);
+
+  // |indexes_| is never modified after construction, so it's safe to read
+  // from any thread.
+  const auto iter = indexes_.find(histogram_name);
+  if (iter == indexes_.end()) {
+    NOTREACHED() << "Unknown histogram " << histogram_name;
+    return false;
+  }
+
+  buckets_[iter->second].store(bucket);
+  return !take_scheduled_.exchange(true);
+}
+
+std::vector<std::pair<base::StringPiece, uint64_t>>
+BraveP3AHistogramBuffer::TakeBuckets() {
+  // Reset the flag first, so that a bucket set while we are collecting is
+  // either taken now or scheduled again.
+  take_scheduled_.store(false);
+
+  std::vector<std::pair<base::StringPiece, uint64_t>> buckets;
+  for (const auto& entry : indexes_) {
+    const uint64_t bucket = buckets_[entry.second].exchange(kNoBucket);
+    if (bucket != kNoBucket) {
+      buckets.emplace_back(entry.first, bucket);
+    }
+  }
+  return buckets;
+}
+
+}  // namespace brave
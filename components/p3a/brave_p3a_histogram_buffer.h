@@ -0,0 +1,50 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_P3A_BRAVE_P3A_HISTOGRAM_BUFFER_H_
+#define BRAVE_COMPONENTS_P3A_BRAVE_P3A_HISTOGRAM_BUFFER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+namespace brave {
+
+// Keeps the latest bucket of each collected histogram until the owner takes
+// them, so that a histogram recording many samples results in a single
+// update. Buckets can be set from any thread without locking.
+class BraveP3AHistogramBuffer {
+ public:
+  // |histogram_names| must outlive the buffer.
+  explicit BraveP3AHistogramBuffer(
+      const std::vector<base::StringPiece>& histogram_names);
+  ~BraveP3AHistogramBuffer();
+
+  // Stores |bucket| as the latest bucket of |histogram_name|. Returns true if
+  // the caller should schedule |TakeBuckets()|, i.e. it's the first bucket
+  // set since the buckets were last taken.
+  bool SetBucket(base::StringPiece histogram_name, uint64_t bucket);
+
+  // Returns the latest bucket of each histogram set since the last call.
+  std::vector<std::pair<base::StringPiece, uint64_t>> TakeBuckets();
+
+ private:
+  base::flat_map<base::StringPiece, size_t> indexes_;
+  std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+  std::atomic<bool> take_scheduled_;
+
+  DISALLOW_COPY_AND_ASSIGN(BraveP3AHistogramBuffer);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_COMPONENTS_P3A_BRAVE_P3A_HISTOGRAM_BUFFER_H_
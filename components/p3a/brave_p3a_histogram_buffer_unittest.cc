@@ -0,0 +1,41 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/p3a/brave_p3a_histogram_buffer.h"
+
+#include <utility>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+// npm run test -- brave_unit_tests --filter=BraveP3AHistogramBufferTest.*
+
+namespace brave {
+
+namespace {
+
+constexpr char kTabCountHistogram[] = "Brave.Core.TabCount";
+constexpr char kWindowCountHistogram[] = "Brave.Core.WindowCount.2";
+
+}  // namespace
+
+TEST(BraveP3AHistogramBufferTest, LatestBucketIsTaken) {
+  BraveP3AHistogramBuffer histogram_buffer(
+      {kTabCountHistogram, kWindowCountHistogram});
+
+  EXPECT_TRUE(histogram_buffer.SetBucket(kTabCountHistogram, 1));
+  EXPECT_FALSE(histogram_buffer.SetBucket(kWindowCountHistogram, 4));
+  EXPECT_FALSE(histogram_buffer.SetBucket(kTabCountHistogram, 3));
+
+  const std::vector<std::pair<base::StringPiece, uint64_t>> expected_buckets =
+      {{kTabCountHistogram, 3}, {kWindowCountHistogram, 4}};
+  EXPECT_EQ(expected_buckets, histogram_buffer.TakeBuckets());
+  EXPECT_TRUE(histogram_buffer.TakeBuckets().empty());
+
+  // A new flush has to be scheduled once the buckets were taken.
+  EXPECT_TRUE(histogram_buffer.SetBucket(kWindowCountHistogram, 5));
+}
+
+}  // namespace brave
@@ -51,6 +51,13 @@ void BraveP3ALogStore::RegisterPrefs(PrefRegistrySimple* registry) {
 
 void BraveP3ALogStore::UpdateValue(const std::string& histogram_name,
                                    uint64_t value) {
+  const auto iter = log_.find(histogram_name);
+  if (iter != log_.end() && iter->second.value == value) {
+    // Neither the value nor the sent flag change, so there is nothing to
+    // persist.
+    return;
+  }
+
   LogEntry& entry = log_[histogram_name];
   entry.value = value;
   if (!entry.sent) {
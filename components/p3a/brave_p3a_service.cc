@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/command_line.h"
 #include "base/i18n/timezone.h"
@@ -27,6 +28,7 @@
 #include "brave/components/brave_prochlo/prochlo_message.pb.h"
 #include "brave/components/brave_referrals/common/pref_names.h"
 #include "brave/components/p3a/brave_p2a_protocols.h"
+#include "brave/components/p3a/brave_p3a_histogram_buffer.h"
 #include "brave/components/p3a/brave_p3a_log_store.h"
 #include "brave/components/p3a/brave_p3a_scheduler.h"
 #include "brave/components/p3a/brave_p3a_switches.h"
@@ -46,7 +48,6 @@ namespace {
 // Receiving this value will effectively prevent the metric from transmission
 // to the backend. For now we consider this as a hack for p2a metrics, which
 // should be refactored in better times.
-constexpr int32_t kSuspendedMetricValue = INT_MAX - 1;
 constexpr uint64_t kSuspendedMetricBucket = INT_MAX - 1;
 
 constexpr char kLastRotationTimeStampPref[] = "p3a.last_rotation_timestamp";
@@ -56,6 +57,11 @@ constexpr char kP2AServerUrl[] = "https://p2a.brave.com/";
 
 constexpr uint64_t kDefaultUploadIntervalSeconds = 60;  // 1 minute.
 
+// Histogram buckets recorded within this interval are applied to the log
+// store at once.
+constexpr base::TimeDelta kHistogramBufferInterval =
+    base::TimeDelta::FromSeconds(1);
+
 // TODO(iefremov): Provide moar histograms!
 // Whitelist for histograms that we collect. Will be replaced with something
 // updating on the fly.
@@ -166,6 +172,10 @@ constexpr const char* kCollectedHistograms[] = {
 };
 // clang-format on
 
+std::vector<base::StringPiece> GetCollectedHistograms() {
+  return {std::begin(kCollectedHistograms), std::end(kCollectedHistograms)};
+}
+
 bool IsSuspendedMetric(base::StringPiece metric_name,
                        uint64_t value_or_bucket) {
   return value_or_bucket == kSuspendedMetricBucket;
@@ -197,7 +207,8 @@ base::TimeDelta TimeDeltaTillMonday(base::Time time) {
 }  // namespace
 
 BraveP3AService::BraveP3AService(PrefService* local_state)
-    : local_state_(local_state) {}
+    : local_state_(local_state),
+      histogram_buffer_(GetCollectedHistograms()) {}
 
 BraveP3AService::~BraveP3AService() = default;
 
@@ -408,15 +419,10 @@ void BraveP3AService::OnHistogramChanged(const char* histogram_name,
       base::StatisticsRecorder::FindHistogram(histogram_name)->SnapshotDelta();
   DCHECK(!samples->Iterator()->Done());
 
-  // Shortcut for the special values, see |kSuspendedMetricValue|
+  // Shortcut for the special values, see |kSuspendedMetricBucket|
   // description for details.
   if (IsSuspendedMetric(histogram_name, sample)) {
-    base::PostTask(FROM_HERE, {content::BrowserThread::UI},
-                   base::BindOnce(&BraveP3AService::OnHistogramChangedOnUI,
-                                  this,
-                                  histogram_name,
-                                  kSuspendedMetricValue,
-                                  kSuspendedMetricBucket));
+    BufferHistogramBucket(histogram_name, kSuspendedMetricBucket);
     return;
   }
 
@@ -445,16 +451,31 @@ void BraveP3AService::OnHistogramChanged(const char* histogram_name,
     bucket = DirectEncodingProtocol::Perturb(bucket_count, bucket);
   }
 
-  base::PostTask(FROM_HERE, {content::BrowserThread::UI},
-                 base::BindOnce(&BraveP3AService::OnHistogramChangedOnUI, this,
-                                histogram_name, sample, bucket));
+  BufferHistogramBucket(histogram_name, bucket);
+}
+
+void BraveP3AService::BufferHistogramBucket(const char* histogram_name,
+                                            uint64_t bucket) {
+  // Only the first bucket since the last flush posts a task, later ones just
+  // replace the buffered bucket.
+  if (histogram_buffer_.SetBucket(histogram_name, bucket)) {
+    base::PostDelayedTask(
+        FROM_HERE, {content::BrowserThread::UI},
+        base::BindOnce(&BraveP3AService::FlushHistogramBucketsOnUI, this),
+        kHistogramBufferInterval);
+  }
+}
+
+void BraveP3AService::FlushHistogramBucketsOnUI() {
+  for (const auto& entry : histogram_buffer_.TakeBuckets()) {
+    OnHistogramChangedOnUI(entry.first, entry.second);
+  }
 }
 
-void BraveP3AService::OnHistogramChangedOnUI(const char* histogram_name,
-                                             base::HistogramBase::Sample sample,
+void BraveP3AService::OnHistogramChangedOnUI(base::StringPiece histogram_name,
                                              size_t bucket) {
   VLOG(2) << "BraveP3AService::OnHistogramChanged: histogram_name = "
-          << histogram_name << " Sample = " << sample << " bucket = " << bucket;
+          << histogram_name << " bucket = " << bucket;
   if (!initialized_) {
     // Will handle it later when ready.
     histogram_values_[histogram_name] = bucket;
@@ -14,6 +14,7 @@
 #include "base/metrics/histogram_base.h"
 #include "base/timer/timer.h"
 #include "brave/components/brave_prochlo/brave_prochlo_message.h"
+#include "brave/components/p3a/brave_p3a_histogram_buffer.h"
 #include "brave/components/p3a/brave_p3a_log_store.h"
 #include "url/gurl.h"
 
@@ -68,14 +69,17 @@ class BraveP3AService : public base::RefCountedThreadSafe<BraveP3AService>,
   void StartScheduledUpload();
 
   // Invoked by callbacks registered by our service. Since these callbacks
-  // can fire on any thread, this method reposts everything to UI thread.
+  // can fire on any thread, this method buffers the bucket for UI thread.
   void OnHistogramChanged(const char* histogram_name,
                           uint64_t name_hash,
                           base::HistogramBase::Sample sample);
 
-  void OnHistogramChangedOnUI(const char* histogram_name,
-                              base::HistogramBase::Sample sample,
-                              size_t bucket);
+  // Posts a flush of the buffered buckets to UI thread, unless one is pending.
+  void BufferHistogramBucket(const char* histogram_name, uint64_t bucket);
+
+  void FlushHistogramBucketsOnUI();
+
+  void OnHistogramChangedOnUI(base::StringPiece histogram_name, size_t bucket);
 
   // Updates or removes a metric from the log.
   void HandleHistogramChange(base::StringPiece histogram_name, size_t bucket);
@@ -105,6 +109,10 @@ class BraveP3AService : public base::RefCountedThreadSafe<BraveP3AService>,
   std::unique_ptr<BraveP3AUploader> uploader_;
   std::unique_ptr<BraveP3AScheduler> upload_scheduler_;
 
+  // Latest buckets of the histograms that changed since the last flush to UI
+  // thread. Thread-safe.
+  BraveP3AHistogramBuffer histogram_buffer_;
+
   // Used to store histogram values that are produced between constructing
   // the service and its initialization.
   base::flat_map<base::StringPiece, size_t> histogram_values_;
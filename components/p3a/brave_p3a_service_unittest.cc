@@ -0,0 +1,136 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/p3a/brave_p3a_service.h"
+
+#include <memory>
+#include <string>
+
+#include "base/command_line.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/test/bind.h"
+#include "base/test/scoped_command_line.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "brave/common/pref_names.h"
+#include "brave/components/brave_referrals/common/pref_names.h"
+#include "brave/components/p3a/brave_p3a_switches.h"
+#include "components/prefs/pref_change_registrar.h"
+#include "components/prefs/testing_pref_service.h"
+#include "content/public/test/browser_task_environment.h"
+#include "services/network/public/cpp/weak_wrapper_shared_url_loader_factory.h"
+#include "services/network/test/test_url_loader_factory.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// npm run test -- brave_unit_tests --filter=BraveP3AServiceTest.*
+
+namespace brave {
+
+namespace {
+
+constexpr char kLogsPrefName[] = "p3a.logs";
+
+constexpr char kTabCountHistogram[] = "Brave.Core.TabCount";
+constexpr char kWindowCountHistogram[] = "Brave.Core.WindowCount.2";
+
+// Matches the interval at which the service applies buffered buckets.
+constexpr base::TimeDelta kFlushInterval = base::TimeDelta::FromSeconds(1);
+
+}  // namespace
+
+class BraveP3AServiceTest : public ::testing::Test {
+ public:
+  BraveP3AServiceTest()
+      : statistics_recorder_(
+            base::StatisticsRecorder::CreateTemporaryForTesting()) {
+    // Keeps uploads from being scheduled within the intervals under test.
+    scoped_command_line_.GetProcessCommandLine()->AppendSwitch(
+        switches::kP3ADoNotRandomizeUploadInterval);
+
+    BraveP3AService::RegisterPrefs(pref_service_.registry(), true);
+    pref_service_.registry()->RegisterStringPref(kWeekOfInstallation,
+                                                 std::string());
+    pref_service_.registry()->RegisterStringPref(kReferralPromoCode,
+                                                 std::string());
+
+    service_ = base::MakeRefCounted<BraveP3AService>(&pref_service_);
+    service_->InitCallbacks();
+    service_->Init(
+        base::MakeRefCounted<network::WeakWrapperSharedURLLoaderFactory>(
+            &url_loader_factory_));
+
+    pref_change_registrar_.Init(&pref_service_);
+    pref_change_registrar_.Add(
+        kLogsPrefName,
+        base::BindLambdaForTesting([this]() { pref_mutations_++; }));
+  }
+
+ protected:
+  std::string GetLoggedValue(const char* histogram_name) {
+    const base::Value* entry =
+        pref_service_.GetDictionary(kLogsPrefName)->FindKey(histogram_name);
+    if (!entry) {
+      return std::string();
+    }
+
+    const std::string* value = entry->FindStringKey("value");
+    return value ? *value : std::string();
+  }
+
+  content::BrowserTaskEnvironment task_environment_{
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME};
+  base::test::ScopedCommandLine scoped_command_line_;
+  network::TestURLLoaderFactory url_loader_factory_;
+  TestingPrefServiceSimple pref_service_;
+  // Owns the histogram callbacks, which keep a reference to |service_|.
+  std::unique_ptr<base::StatisticsRecorder> statistics_recorder_;
+  scoped_refptr<BraveP3AService> service_;
+  PrefChangeRegistrar pref_change_registrar_;
+  int pref_mutations_ = 0;
+};
+
+TEST_F(BraveP3AServiceTest, IdenticalSamplesMutatePrefsOnce) {
+  const size_t pending_tasks =
+      task_environment_.GetPendingMainThreadTaskCount();
+  for (int i = 0; i < 1000; i++) {
+    base::UmaHistogramExactLinear(kTabCountHistogram, 2, 8);
+  }
+
+  // All of the samples are applied by a single task.
+  EXPECT_EQ(pending_tasks + 1,
+            task_environment_.GetPendingMainThreadTaskCount());
+  EXPECT_EQ(0, pref_mutations_);
+
+  task_environment_.FastForwardBy(kFlushInterval);
+  EXPECT_EQ(1, pref_mutations_);
+  EXPECT_EQ("2", GetLoggedValue(kTabCountHistogram));
+
+  // The same bucket once the value is stored doesn't touch prefs at all.
+  for (int i = 0; i < 1000; i++) {
+    base::UmaHistogramExactLinear(kTabCountHistogram, 2, 8);
+  }
+
+  task_environment_.FastForwardBy(kFlushInterval);
+  EXPECT_EQ(1, pref_mutations_);
+}
+
+TEST_F(BraveP3AServiceTest, ChangedBucketMutatesPrefs) {
+  base::UmaHistogramExactLinear(kTabCountHistogram, 2, 8);
+  task_environment_.FastForwardBy(kFlushInterval);
+  ASSERT_EQ(1, pref_mutations_);
+
+  // Only the latest bucket of each histogram is applied.
+  base::UmaHistogramExactLinear(kTabCountHistogram, 1, 8);
+  base::UmaHistogramExactLinear(kTabCountHistogram, 3, 8);
+  base::UmaHistogramExactLinear(kWindowCountHistogram, 1, 4);
+  task_environment_.FastForwardBy(kFlushInterval);
+  EXPECT_EQ(3, pref_mutations_);
+  EXPECT_EQ("3", GetLoggedValue(kTabCountHistogram));
+  EXPECT_EQ("1", GetLoggedValue(kWindowCountHistogram));
+}
+
+}  // namespace brave
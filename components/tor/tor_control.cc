@@ -5,6 +5,7 @@
 
 #include "brave/components/tor/tor_control.h"
 
+#include "base/callback_helpers.h"
 #include "base/sequenced_task_runner.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
@@ -43,6 +44,10 @@ constexpr char kGetSOCKSListenersReply[] = "net/listeners/socks=";
 constexpr char kGetCircuitEstablishedCmd[] =
     "GETINFO status/circuit-established";
 constexpr char kGetCircuitEstablishedReply[] = "status/circuit-established=";
+// Circuit id 0 asks Tor to pick a path and build a new general-purpose
+// circuit.
+constexpr char kExtendCircuitCmd[] = "EXTENDCIRCUIT 0";
+constexpr char kExtendCircuitReply[] = "EXTENDED ";
 
 static std::string escapify(const char* buf, int len) {
   std::ostringstream s;
@@ -516,6 +521,39 @@ void TorControl::GetCircuitEstablishedDone(
   std::move(callback).Run(false, result);
 }
 
+// ExtendCircuit(callback)
+//
+//      Ask Tor to build a new clean circuit and call callback(error) once it
+//      has been launched.  The first stream of a new isolation group may be
+//      attached to any clean circuit, so this saves that stream the circuit
+//      construction.
+//
+void TorControl::ExtendCircuit(base::OnceCallback<void(bool error)> callback) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(owner_sequence_checker_);
+  io_task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&TorControl::DoCmd, weak_ptr_factory_.GetWeakPtr(),
+                     kExtendCircuitCmd, PerLineCallback(base::DoNothing()),
+                     base::BindOnce(&TorControl::ExtendCircuitDone,
+                                    weak_ptr_factory_.GetWeakPtr(),
+                                    std::move(callback))));
+}
+
+void TorControl::ExtendCircuitDone(
+    base::OnceCallback<void(bool error)> callback,
+    bool error,
+    const std::string& status,
+    const std::string& reply) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(io_sequence_checker_);
+  if (error || status != "250" ||
+      !base::StartsWith(reply, kExtendCircuitReply,
+                        base::CompareCase::SENSITIVE)) {
+    std::move(callback).Run(true);
+    return;
+  }
+  std::move(callback).Run(false);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Writing state machine
 
@@ -92,6 +92,7 @@ class TorControl {
           callback);
   void GetCircuitEstablished(
       base::OnceCallback<void(bool error, bool established)> callback);
+  void ExtendCircuit(base::OnceCallback<void(bool error)> callback);
 
  protected:
   friend class TorControlTest;
@@ -99,6 +100,7 @@ class TorControl {
   FRIEND_TEST_ALL_PREFIXES(TorControlTest, ParseKV);
   FRIEND_TEST_ALL_PREFIXES(TorControlTest, ReadLine);
   FRIEND_TEST_ALL_PREFIXES(TorControlTest, GetCircuitEstablishedDone);
+  FRIEND_TEST_ALL_PREFIXES(TorControlTest, ExtendCircuitDone);
 
   static bool ParseKV(const std::string& string,
                       std::string* key,
@@ -149,6 +151,10 @@ class TorControl {
       bool error,
       const std::string& status,
       const std::string& reply);
+  void ExtendCircuitDone(base::OnceCallback<void(bool error)> callback,
+                         bool error,
+                         const std::string& status,
+                         const std::string& reply);
 
   void DoSubscribe(TorControlEvent event,
                    base::OnceCallback<void(bool error)> callback);
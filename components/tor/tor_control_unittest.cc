@@ -300,4 +300,45 @@ TEST(TorControlTest, GetCircuitEstablishedDone) {
   base::RunLoop().RunUntilIdle();
 }
 
+TEST(TorControlTest, ExtendCircuitDone) {
+  content::BrowserTaskEnvironment task_environment;
+  scoped_refptr<base::SequencedTaskRunner> io_task_runner =
+      content::GetIOThreadTaskRunner({});
+
+  MockTorControlDelegate delegate;
+  std::unique_ptr<TorControl> control =
+      std::make_unique<TorControl>(delegate.AsWeakPtr(), io_task_runner);
+
+  io_task_runner->PostTask(
+      FROM_HERE, base::BindOnce(
+                     [](std::unique_ptr<TorControl> control) {
+                       const struct {
+                         bool error;
+                         const char* status;
+                         const char* reply;
+                         bool expected_error;
+                       } cases[] = {
+                           {false, "250", "EXTENDED 42", false},
+                           {true, "250", "EXTENDED 42", true},
+                           {false, "552", "Unknown circuit \"0\"", true},
+                           {false, "250", "OK", true},
+                       };
+                       for (const auto& c : cases) {
+                         bool is_called = false;
+                         control->ExtendCircuitDone(
+                             base::BindOnce(
+                                 [](bool* is_called, bool expected_error,
+                                    bool error) {
+                                   *is_called = true;
+                                   EXPECT_EQ(expected_error, error);
+                                 },
+                                 &is_called, c.expected_error),
+                             c.error, c.status, c.reply);
+                         EXPECT_TRUE(is_called);
+                       }
+                     },
+                     std::move(control)));
+  base::RunLoop().RunUntilIdle();
+}
+
 }  // namespace tor
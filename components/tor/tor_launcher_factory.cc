@@ -30,6 +30,11 @@ constexpr char kStatusClientBootstrap[] = "BOOTSTRAP";
 constexpr char kStatusClientBootstrapProgress[] = "PROGRESS=";
 constexpr char kStatusClientCircuitEstablished[] = "CIRCUIT_ESTABLISHED";
 constexpr char kStatusClientCircuitNotEstablished[] = "CIRCUIT_NOT_ESTABLISHED";
+// Budget for circuits prewarmed ahead of a first request. A prewarmed key is
+// not prewarmed again until its circuit would have gone dirty.
+constexpr size_t kMaxPrewarmedCircuits = 4;
+constexpr base::TimeDelta kPrewarmedCircuitLifetime =
+    base::TimeDelta::FromMinutes(10);
 
 std::pair<bool, std::string> LoadTorLogOnFileTaskRunner(
     const base::FilePath& path) {
@@ -138,6 +143,7 @@ void TorLauncherFactory::KillTorProcess() {
   tor_launcher_.reset();
   tor_pid_ = -1;
   is_connected_ = false;
+  prewarmed_circuits_.clear();
 }
 
 int64_t TorLauncherFactory::GetTorPid() const {
@@ -175,6 +181,38 @@ void TorLauncherFactory::GetTorLog(GetLogCallback callback) {
                      weak_ptr_factory_.GetWeakPtr(), std::move(callback)));
 }
 
+void TorLauncherFactory::PrewarmCircuit(const std::string& isolation_key) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!is_connected_ || isolation_key.empty())
+    return;
+
+  const base::TimeTicks now = base::TimeTicks::Now();
+  base::EraseIf(prewarmed_circuits_, [now](const auto& prewarmed) {
+    return now - prewarmed.second >= kPrewarmedCircuitLifetime;
+  });
+  if (prewarmed_circuits_.contains(isolation_key) ||
+      prewarmed_circuits_.size() >= kMaxPrewarmedCircuits)
+    return;
+
+  // The isolation key only feeds the budget; Tor gets a plain clean circuit
+  // that is not tied to any site until a stream is attached to it.
+  prewarmed_circuits_[isolation_key] = now;
+  control_->ExtendCircuit(base::BindPostTask(
+      base::SequencedTaskRunnerHandle::Get(),
+      base::BindOnce(&TorLauncherFactory::CircuitPrewarmed,
+                     weak_ptr_factory_.GetWeakPtr(), isolation_key)));
+}
+
+void TorLauncherFactory::CircuitPrewarmed(const std::string& isolation_key,
+                                          bool error) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (error) {
+    VLOG(1) << "Failed to prewarm circuit!";
+    // Give the budget back.
+    prewarmed_circuits_.erase(isolation_key);
+  }
+}
+
 void TorLauncherFactory::AddObserver(TorLauncherObserver* observer) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   observers_.AddObserver(observer);
@@ -300,6 +338,7 @@ void TorLauncherFactory::GotCircuitEstablished(bool error, bool established) {
 void TorLauncherFactory::OnTorControlClosed(bool was_running) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   VLOG(2) << "TOR CONTROL: Closed!";
+  prewarmed_circuits_.clear();
   // If we're still running, try watching again to start over.
   // TODO(riastradh-brave): Rate limit in case of flapping?
   if (was_running) {
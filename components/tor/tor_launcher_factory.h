@@ -13,10 +13,12 @@
 #include <vector>
 
 #include "base/callback.h"
+#include "base/containers/flat_map.h"
 #include "base/memory/singleton.h"
 #include "base/memory/weak_ptr.h"
 #include "base/observer_list.h"
 #include "base/sequence_checker.h"
+#include "base/time/time.h"
 #include "brave/components/services/tor/public/interfaces/tor.mojom.h"
 #include "brave/components/tor/tor_control.h"
 #include "mojo/public/cpp/bindings/remote.h"
@@ -42,6 +44,9 @@ class TorLauncherFactory : public tor::TorControl::Delegate {
   virtual std::string GetTorProxyURI() const;
   virtual std::string GetTorVersion() const;
   virtual void GetTorLog(GetLogCallback);
+  // Asks Tor for a clean circuit ahead of the first request for
+  // |isolation_key|, within a small budget of prewarmed circuits.
+  virtual void PrewarmCircuit(const std::string& isolation_key);
 
   void AddObserver(TorLauncherObserver* observer);
   void RemoveObserver(TorLauncherObserver* observer);
@@ -79,6 +84,7 @@ class TorLauncherFactory : public tor::TorControl::Delegate {
   void GotVersion(bool error, const std::string& version);
   void GotSOCKSListeners(bool error, const std::vector<std::string>& listeners);
   void GotCircuitEstablished(bool error, bool established);
+  void CircuitPrewarmed(const std::string& isolation_key, bool error);
 
   void LaunchTorInternal();
   void RelaunchTor();
@@ -96,6 +102,9 @@ class TorLauncherFactory : public tor::TorControl::Delegate {
 
   tor::mojom::TorConfig config_;
 
+  // Isolation keys a circuit has been prewarmed for, and when.
+  base::flat_map<std::string, base::TimeTicks> prewarmed_circuits_;
+
   base::ObserverList<TorLauncherObserver> observers_;
 
   std::unique_ptr<tor::TorControl, base::OnTaskRunnerDeleter> control_;
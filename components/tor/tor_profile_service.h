@@ -28,6 +28,7 @@ namespace user_prefs {
 class PrefRegistrySyncable;
 }
 
+class GURL;
 class TorLauncherFactory;
 class PrefRegistrySimple;
 
@@ -44,6 +45,8 @@ class TorProfileService : public KeyedService {
   virtual void RegisterTorClientUpdater() = 0;
   virtual void UnregisterTorClientUpdater() = 0;
   virtual void SetNewTorCircuit(content::WebContents* web_contents) = 0;
+  // Prepares a circuit for the likely next request to |url|.
+  virtual void PrewarmCircuit(const GURL& url) = 0;
   virtual std::unique_ptr<net::ProxyConfigService>
       CreateProxyConfigService() = 0;
   virtual bool IsTorConnected() = 0;
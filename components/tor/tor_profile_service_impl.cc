@@ -211,6 +211,14 @@ void TorProfileServiceImpl::SetNewTorCircuit(WebContents* tab) {
       url, network_isolation_key, std::move(proxy_lookup_client));
 }
 
+void TorProfileServiceImpl::PrewarmCircuit(const GURL& url) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  if (!tor_launcher_factory_ || !url.SchemeIsHTTPOrHTTPS())
+    return;
+  tor_launcher_factory_->PrewarmCircuit(
+      net::ProxyConfigServiceTor::CircuitIsolationKey(url));
+}
+
 void TorProfileServiceImpl::KillTor() {
   if (tor_launcher_factory_)
     tor_launcher_factory_->KillTorProcess();
@@ -44,6 +44,7 @@ class TorProfileServiceImpl : public TorProfileService,
   void RegisterTorClientUpdater() override;
   void UnregisterTorClientUpdater() override;
   void SetNewTorCircuit(content::WebContents* web_contents) override;
+  void PrewarmCircuit(const GURL& url) override;
   std::unique_ptr<net::ProxyConfigService> CreateProxyConfigService() override;
   bool IsTorConnected() override;
   void KillTor() override;
@@ -6,21 +6,35 @@
 #include "brave/components/tor/tor_tab_helper.h"
 
 #include "base/threading/sequenced_task_runner_handle.h"
+#include "brave/components/tor/tor_profile_service.h"
 #include "content/public/browser/navigation_handle.h"
 
 namespace tor {
 
-TorTabHelper::TorTabHelper(content::WebContents* web_contents)
-    : content::WebContentsObserver(web_contents) {}
+TorTabHelper::TorTabHelper(content::WebContents* web_contents,
+                           TorProfileService* tor_profile_service)
+    : content::WebContentsObserver(web_contents),
+      tor_profile_service_(tor_profile_service) {}
 
 TorTabHelper::~TorTabHelper() = default;
 
 // static
-void TorTabHelper::MaybeCreateForWebContents(content::WebContents* web_contents,
-                                             bool is_tor_profile) {
-  if (!is_tor_profile)
+void TorTabHelper::MaybeCreateForWebContents(
+    content::WebContents* web_contents,
+    TorProfileService* tor_profile_service) {
+  if (!tor_profile_service)
     return;
-  TorTabHelper::CreateForWebContents(web_contents);
+  TorTabHelper::CreateForWebContents(web_contents, tor_profile_service);
+}
+
+void TorTabHelper::DidStartNavigation(
+    content::NavigationHandle* navigation_handle) {
+  // Get a circuit going for the tab's new isolation key while the rest of the
+  // navigation is set up.
+  if (!navigation_handle->IsInMainFrame() ||
+      navigation_handle->IsSameDocument())
+    return;
+  tor_profile_service_->PrewarmCircuit(navigation_handle->GetURL());
 }
 
 void TorTabHelper::DidFinishNavigation(
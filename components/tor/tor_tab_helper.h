@@ -17,25 +17,33 @@ class WebContents;
 
 namespace tor {
 
+class TorProfileService;
+
 class TorTabHelper : public content::WebContentsObserver,
                      public content::WebContentsUserData<TorTabHelper>,
                      public base::SupportsWeakPtr<TorTabHelper> {
  public:
   ~TorTabHelper() override;
 
+  // |tor_profile_service| is null for non-Tor profiles.
   static void MaybeCreateForWebContents(content::WebContents* web_contents,
-                                        bool is_tor_profile);
+                                        TorProfileService* tor_profile_service);
 
  private:
   friend class content::WebContentsUserData<TorTabHelper>;
-  explicit TorTabHelper(content::WebContents* web_contents);
+  TorTabHelper(content::WebContents* web_contents,
+               TorProfileService* tor_profile_service);
 
   // content::WebContentsObserver
+  void DidStartNavigation(
+      content::NavigationHandle* navigation_handle) override;
   void DidFinishNavigation(
       content::NavigationHandle* navigation_handle) override;
 
   void ReloadTab(content::WebContents* web_contents);
 
+  TorProfileService* tor_profile_service_;  // NOT OWNED
+
   WEB_CONTENTS_USER_DATA_KEY_DECL();
 
   DISALLOW_COPY_AND_ASSIGN(TorTabHelper);
@@ -5,9 +5,11 @@
 
 #include "brave/components/weekly_storage/weekly_storage.h"
 
+#include <algorithm>
 #include <numeric>
 #include <utility>
 
+#include "base/bind.h"
 #include "base/time/clock.h"
 #include "base/time/default_clock.h"
 #include "base/values.h"
@@ -16,7 +18,9 @@
 
 namespace {
 constexpr size_t kDaysInWeek = 7;
-}
+// Matches the interval prefs are committed to disk at.
+constexpr base::TimeDelta kFlushDelay = base::TimeDelta::FromSeconds(10);
+}  // namespace
 
 WeeklyStorage::WeeklyStorage(PrefService* prefs, const char* pref_name)
     : prefs_(prefs),
@@ -37,12 +41,16 @@ WeeklyStorage::WeeklyStorage(PrefService* prefs,
   Load();
 }
 
-WeeklyStorage::~WeeklyStorage() = default;
+WeeklyStorage::~WeeklyStorage() {
+  Flush();
+}
 
 void WeeklyStorage::AddDelta(uint64_t delta) {
   FilterToWeek();
-  daily_values_.front().value += delta;
-  Save();
+  DailyValue& today = daily_values_.front();
+  today.value += delta;
+  pending_changes_[today.day].delta += delta;
+  ScheduleFlush();
 }
 
 void WeeklyStorage::ReplaceTodaysValueIfGreater(uint64_t value) {
@@ -51,7 +59,9 @@ void WeeklyStorage::ReplaceTodaysValueIfGreater(uint64_t value) {
   if (today.value < value) {
     today.value = value;
   }
-  Save();
+  PendingChange& change = pending_changes_[today.day];
+  change.maximum = std::max(change.maximum, value);
+  ScheduleFlush();
 }
 
 uint64_t WeeklyStorage::GetWeeklySum() const {
@@ -98,15 +108,45 @@ bool WeeklyStorage::IsOneWeekPassed() const {
   return daily_values_.size() == kDaysInWeek;
 }
 
-void WeeklyStorage::FilterToWeek() {
-  base::Time now_midnight = clock_->Now().LocalMidnight();
-  base::Time last_saved_midnight;
+void WeeklyStorage::Flush() {
+  flush_timer_.Stop();
+  if (pending_changes_.empty()) {
+    return;
+  }
+  if (!prefs_) {
+    pending_changes_.clear();
+    return;
+  }
+
+  // Other instances may have written to the same pref in the meantime, so
+  // start over from what is stored and apply this instance's changes on top.
+  daily_values_.clear();
+  Load();
+  for (const auto& change : pending_changes_) {
+    ApplyPendingChange(change.first, change.second);
+  }
+  pending_changes_.clear();
+  Save();
+}
 
+bool WeeklyStorage::IsNewDay(base::Time midnight) const {
+  base::Time last_saved_midnight;
   if (!daily_values_.empty()) {
     last_saved_midnight = daily_values_.front().day;
   }
+  return midnight - last_saved_midnight > base::TimeDelta();
+}
+
+void WeeklyStorage::FilterToWeek() {
+  base::Time now_midnight = clock_->Now().LocalMidnight();
+  if (!IsNewDay(now_midnight)) {
+    return;
+  }
 
-  if (now_midnight - last_saved_midnight > base::TimeDelta()) {
+  // Write out the finished day before starting a new one. This reloads the
+  // stored values, which may already include today.
+  Flush();
+  if (IsNewDay(now_midnight)) {
     // Day changed. Since we consider only small incoming intervals, lets just
     // save it with a new timestamp.
     daily_values_.push_front({now_midnight, 0});
@@ -142,7 +182,6 @@ void WeeklyStorage::Save() {
 
   ListPrefUpdate update(prefs_, pref_name_);
   base::ListValue* list = update.Get();
-  // TODO(iefremov): Optimize if needed.
   list->Clear();
   for (const auto& u : daily_values_) {
     base::DictionaryValue value;
@@ -151,3 +190,27 @@ void WeeklyStorage::Save() {
     list->Append(std::move(value));
   }
 }
+
+void WeeklyStorage::ApplyPendingChange(base::Time day,
+                                       const PendingChange& change) {
+  // |daily_values_| is ordered from the newest day to the oldest.
+  auto it = std::find_if(
+      daily_values_.begin(), daily_values_.end(),
+      [day](const DailyValue& daily_value) { return daily_value.day <= day; });
+  if (it == daily_values_.end() || it->day != day) {
+    it = daily_values_.insert(it, {day, 0});
+  }
+  it->value = std::max(it->value + change.delta, change.maximum);
+  if (daily_values_.size() > kDaysInWeek) {
+    daily_values_.pop_back();
+  }
+}
+
+void WeeklyStorage::ScheduleFlush() {
+  if (flush_timer_.IsRunning()) {
+    return;
+  }
+  flush_timer_.Start(
+      FROM_HERE, kFlushDelay,
+      base::BindOnce(&WeeklyStorage::Flush, base::Unretained(this)));
+}
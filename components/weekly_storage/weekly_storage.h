@@ -7,9 +7,11 @@
 #define BRAVE_COMPONENTS_WEEKLY_STORAGE_WEEKLY_STORAGE_H_
 
 #include <list>
+#include <map>
 #include <memory>
 
 #include "base/time/time.h"
+#include "base/timer/timer.h"
 
 namespace base {
 class Clock;
@@ -20,6 +22,10 @@ class PrefService;
 // Mostly used by various P3A recorders - allows to track a sum of some
 // values added from time to time via |AddDelta| over a last week.
 // Requires |pref_name| to be already registered.
+// Changes are kept in memory and written to prefs after a short delay, on day
+// rollover or on destruction. Writes are applied on top of the values stored
+// at that time, so several instances may share a pref, though each only sees
+// the others' changes once it writes its own.
 // Feel free to improve and refactor it - templatize a stored value type,
 // change weekly interval or make a keyed service from it.
 class WeeklyStorage {
@@ -41,20 +47,34 @@ class WeeklyStorage {
   uint64_t GetHighestValueInWeek() const;
   bool IsOneWeekPassed() const;
 
+  // Writes pending changes to prefs now rather than waiting for the timer.
+  void Flush();
+
  private:
   struct DailyValue {
     base::Time day;
     uint64_t value = 0ull;
   };
+  // Changes made to a day since the last write.
+  struct PendingChange {
+    uint64_t delta = 0ull;
+    uint64_t maximum = 0ull;
+  };
+  bool IsNewDay(base::Time midnight) const;
   void FilterToWeek();
   void Load();
   void Save();
+  void ApplyPendingChange(base::Time day, const PendingChange& change);
+  void ScheduleFlush();
 
   PrefService* prefs_ = nullptr;
   const char* pref_name_ = nullptr;
   std::unique_ptr<base::Clock> clock_;
 
   std::list<DailyValue> daily_values_;
+
+  std::map<base::Time, PendingChange> pending_changes_;
+  base::OneShotTimer flush_timer_;
 };
 
 #endif  // BRAVE_COMPONENTS_WEEKLY_STORAGE_WEEKLY_STORAGE_H_
@@ -8,16 +8,22 @@
 #include <memory>
 #include <utility>
 
+#include "base/test/bind.h"
 #include "base/test/simple_test_clock.h"
+#include "base/test/task_environment.h"
 #include "base/time/time.h"
+#include "components/prefs/pref_change_registrar.h"
 #include "components/prefs/pref_registry_simple.h"
 #include "components/prefs/testing_pref_service.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+namespace {
+constexpr char kPrefName[] = "brave.weekly_test";
+}  // namespace
+
 class WeeklyStorageTest : public ::testing::Test {
  public:
   WeeklyStorageTest() : clock_(new base::SimpleTestClock) {
-    constexpr char kPrefName[] = "brave.weekly_test";
     pref_service_.registry()->RegisterListPref(kPrefName);
 
     state_ = std::make_unique<WeeklyStorage>(
@@ -26,6 +32,8 @@ class WeeklyStorageTest : public ::testing::Test {
   }
 
  protected:
+  base::test::TaskEnvironment task_environment_{
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME};
   base::SimpleTestClock* clock_;
   TestingPrefServiceSimple pref_service_;
   std::unique_ptr<WeeklyStorage> state_;
@@ -138,3 +146,67 @@ TEST_F(WeeklyStorageTest, GetsHighestValueInWeekFromReplacement) {
   // Sanity check disparate days were not replaced
   EXPECT_EQ(state_->GetWeeklySum(), high_value + low_value);
 }
+
+TEST_F(WeeklyStorageTest, CoalescesPrefWrites) {
+  int pref_writes = 0;
+  PrefChangeRegistrar registrar;
+  registrar.Init(&pref_service_);
+  registrar.Add(kPrefName,
+                base::BindLambdaForTesting([&pref_writes]() { pref_writes++; }));
+
+  constexpr int kUpdates = 100;
+  for (int i = 0; i < kUpdates; i++) {
+    state_->AddDelta(1);
+    state_->ReplaceTodaysValueIfGreater(0);
+  }
+  EXPECT_EQ(pref_writes, 0);
+  EXPECT_EQ(state_->GetWeeklySum(), static_cast<uint64_t>(kUpdates));
+
+  task_environment_.FastForwardBy(base::TimeDelta::FromMinutes(1));
+  EXPECT_EQ(pref_writes, 1);
+  EXPECT_EQ(pref_service_.GetList(kPrefName)->GetList().size(), 1u);
+}
+
+TEST_F(WeeklyStorageTest, FlushesOnDayRollover) {
+  int pref_writes = 0;
+  PrefChangeRegistrar registrar;
+  registrar.Init(&pref_service_);
+  registrar.Add(kPrefName,
+                base::BindLambdaForTesting([&pref_writes]() { pref_writes++; }));
+
+  state_->AddDelta(10);
+  EXPECT_EQ(pref_writes, 0);
+
+  clock_->Advance(base::TimeDelta::FromDays(1));
+  state_->AddDelta(20);
+  EXPECT_EQ(pref_writes, 1);
+  EXPECT_EQ(state_->GetWeeklySum(), 30ULL);
+}
+
+TEST_F(WeeklyStorageTest, FlushesOnDestruction) {
+  state_->AddDelta(10);
+  EXPECT_TRUE(pref_service_.GetList(kPrefName)->GetList().empty());
+
+  state_.reset();
+  EXPECT_EQ(pref_service_.GetList(kPrefName)->GetList().size(), 1u);
+}
+
+TEST_F(WeeklyStorageTest, InstancesSharingPrefKeepEachOthersChanges) {
+  auto* other_clock = new base::SimpleTestClock;
+  other_clock->SetNow(clock_->Now());
+  WeeklyStorage other(&pref_service_, kPrefName,
+                      std::unique_ptr<base::Clock>(other_clock));
+
+  state_->AddDelta(10);
+  other.AddDelta(20);
+  state_->Flush();
+  other.Flush();
+  EXPECT_EQ(other.GetWeeklySum(), 30ULL);
+
+  // Changes made on a later day are added next to the earlier ones.
+  clock_->Advance(base::TimeDelta::FromDays(1));
+  state_->AddDelta(5);
+  state_->Flush();
+  EXPECT_EQ(state_->GetWeeklySum(), 35ULL);
+  EXPECT_EQ(pref_service_.GetList(kPrefName)->GetList().size(), 2u);
+}
@@ -8,13 +8,17 @@
 #include <stdlib.h>
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "base/bind.h"
 #include "base/no_destructor.h"
+#include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 #include "base/time/time.h"
 #include "base/values.h"
 #include "crypto/random.h"
@@ -40,8 +44,14 @@ class TorProxyMap {
   static std::string GenerateNewPassword();
   // Clear expired entries in the queue from the map.
   void ClearExpiredEntries();
+  // Runs ClearExpiredEntries() when the oldest entry in the queue expires.
+  void ScheduleClearExpiredEntries();
   std::map<std::string, std::pair<std::string, base::Time>> map_;
-  std::priority_queue<std::pair<base::Time, std::string>> queue_;
+  // Oldest entry on top.
+  std::priority_queue<std::pair<base::Time, std::string>,
+                      std::vector<std::pair<base::Time, std::string>>,
+                      std::greater<std::pair<base::Time, std::string>>>
+      queue_;
   base::OneShotTimer timer_;
   DISALLOW_COPY_AND_ASSIGN(TorProxyMap);
 };
@@ -76,21 +86,15 @@ TorProxyMap* GetTorProxyMap(
   return &(tor_proxy_map_.get()->operator[](service));
 }
 
+// Removes the TorProxyMaps all of whose entries have expired. This runs from
+// the expiry timer rather than on every proxy resolution.
+void EraseEmptyTorProxyMaps() {
+  base::EraseIf(*tor_proxy_map_,
+                [](const auto& entry) { return entry.second.size() == 0; });
+}
+
 bool IsTorProxyConfig(const ProxyConfigWithAnnotation& config) {
   auto tag = config.traffic_annotation();
-  // iterate through tor_proxy_map_ and remove any entries with
-  // empty TorProxyMap (all entries have expired)
-  // we do this here because the other methods are only called when
-  // IsTorProxy is true so the last entry will never be deleted
-  for (auto it = tor_proxy_map_.get()->cbegin();
-       it != tor_proxy_map_.get()->cend(); ) {
-    if (it->second.size() == 0) {
-      tor_proxy_map_->erase(it++);
-    } else {
-      ++it;
-    }
-  }
-
   return tag.unique_id_hash_code ==
          kTorProxyTrafficAnnotation.unique_id_hash_code;
 }
@@ -165,6 +169,13 @@ void ProxyConfigServiceTor::SetNewTorCircuit(const GURL& url) {
                                   config_valid);
 }
 
+// static
+size_t ProxyConfigServiceTor::GetCircuitsCountForTesting(
+    ProxyResolutionService* service) {
+  auto found = tor_proxy_map_->find(service);
+  return found == tor_proxy_map_->end() ? 0 : found->second.size();
+}
+
 // static
 void ProxyConfigServiceTor::SetProxyAuthorization(
     const ProxyConfigWithAnnotation& config,
@@ -243,27 +254,26 @@ std::string TorProxyMap::GenerateNewPassword() {
 
 std::string TorProxyMap::Get(
     const std::string& username) {
-  // Clear any expired entries, in case this one has expired.
-  ClearExpiredEntries();
+  const base::Time now = base::Time::Now();
 
-  // Check for an entry for this username.
+  // Check for an entry for this username. The timer clears expired entries in
+  // bulk, so only this one needs checking here in case the timer is late.
   auto found = map_.find(username);
-  if (found != map_.end())
-    return found->second.first;
+  if (found != map_.end()) {
+    if (found->second.second > now - kTenMins)
+      return found->second.first;
+    map_.erase(found);
+  }
 
   // No entry yet.  Check our watch and create one.
-  const base::Time now = base::Time::Now();
   const std::string password = GenerateNewPassword();
   map_.emplace(username, std::make_pair(password, now));
   queue_.emplace(now, username);
 
-  // Reschedule the timer for ten minutes from now so that this entry
-  // won't last more than about ten minutes even if the user stops
-  // using Tor for a while.
-  // TODO(bridiver) - the timer should be in the ProxyConfigServiceTor class
-  timer_.Stop();
-  timer_.Start(FROM_HERE, kTenMins, this,
-               &TorProxyMap::ClearExpiredEntries);
+  // Make sure this entry won't last more than about ten minutes even if the
+  // user stops using Tor for a while.
+  if (!timer_.IsRunning())
+    ScheduleClearExpiredEntries();
 
   return password;
 }
@@ -291,13 +301,23 @@ void TorProxyMap::MaybeExpire(
   }
 }
 
+void TorProxyMap::ScheduleClearExpiredEntries() {
+  DCHECK(!queue_.empty());
+  const base::TimeDelta delay =
+      queue_.top().first + kTenMins - base::Time::Now();
+  timer_.Start(FROM_HERE, std::max(delay, base::TimeDelta()), this,
+               &TorProxyMap::ClearExpiredEntries);
+}
+
 void TorProxyMap::ClearExpiredEntries() {
   const base::Time cutoff = base::Time::Now() - kTenMins;
   for (; !queue_.empty(); queue_.pop()) {
-    // Check the timestamp.  If it's not older than the cutoff, stop.
+    // Check the timestamp.  If it's newer than the cutoff, stop.  Entries
+    // exactly at the cutoff have expired, as in Get(), so that a timer firing
+    // on time always makes progress.
     const std::pair<base::Time, std::string>* entry = &queue_.top();
     const base::Time timestamp = entry->first;
-    if (!(timestamp < cutoff))
+    if (timestamp > cutoff)
       break;
 
     // Remove the corresponding entry in the map if there is one and
@@ -316,6 +336,14 @@ void TorProxyMap::ClearExpiredEntries() {
       }
     }
   }
+
+  if (!queue_.empty()) {
+    ScheduleClearExpiredEntries();
+  } else if (map_.empty()) {
+    // This map may be destroyed by the cleanup, so do it in a separate task.
+    base::SequencedTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::BindOnce(&EraseEmptyTorProxyMaps));
+  }
 }
 
 }  // namespace net
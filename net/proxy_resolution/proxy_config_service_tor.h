@@ -46,6 +46,8 @@ class NET_EXPORT ProxyConfigServiceTor : public net::ProxyConfigService {
                                     const GURL& url,
                                     ProxyResolutionService* service,
                                     ProxyInfo* result);
+  // Returns the number of live circuit isolation entries for |service|.
+  static size_t GetCircuitsCountForTesting(ProxyResolutionService* service);
 
   // ProxyConfigService methods:
   void AddObserver(Observer* observer) override;
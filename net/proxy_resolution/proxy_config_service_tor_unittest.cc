@@ -169,8 +169,6 @@ TEST_F(ProxyConfigServiceTorTest, SetProxyAuthorization) {
   EXPECT_EQ(host_port_pair.host(), "127.0.0.1");
   EXPECT_EQ(host_port_pair.port(), 5566);
 
-  // TODO(darkdh): Test persistent circuit isolation until timeout.
-
   // Test new tor circuit.
   proxy_config_service.SetNewTorCircuit(site_url);
   proxy_config_service.GetLatestProxyConfig(&config);
@@ -211,4 +209,55 @@ TEST_F(ProxyConfigServiceTorTest, SetProxyAuthorization) {
   EXPECT_EQ(host_port_pair.port(), 5566);
 }
 
+class ProxyConfigServiceTorMockTimeTest : public TestWithTaskEnvironment {
+ public:
+  ProxyConfigServiceTorMockTimeTest()
+      : TestWithTaskEnvironment(
+            base::test::TaskEnvironment::TimeSource::MOCK_TIME) {}
+  ~ProxyConfigServiceTorMockTimeTest() override {}
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ProxyConfigServiceTorMockTimeTest);
+};
+
+TEST_F(ProxyConfigServiceTorMockTimeTest, CircuitIsolationExpiry) {
+  const std::string proxy_uri("socks5://127.0.0.1:5566");
+  const GURL site_url("https://check.torproject.org/");
+
+  auto service = std::make_unique<ConfiguredProxyResolutionService>(
+      ConfiguredProxyResolutionService::CreateSystemProxyConfigService(
+          base::ThreadTaskRunnerHandle::Get()),
+      std::make_unique<MockAsyncProxyResolverFactory>(false), nullptr,
+      /*quick_check_enabled=*/true);
+
+  ProxyConfigServiceTor proxy_config_service(proxy_uri);
+  ProxyConfigWithAnnotation config;
+  proxy_config_service.GetLatestProxyConfig(&config);
+
+  auto get_password = [&]() {
+    ProxyInfo info;
+    ProxyConfigServiceTor::SetProxyAuthorization(config, site_url,
+                                                 service.get(), &info);
+    return info.proxy_server().host_port_pair().password();
+  };
+
+  // The circuit persists until it is ten minutes old...
+  const std::string password = get_password();
+  FastForwardBy(base::TimeDelta::FromMinutes(9));
+  EXPECT_EQ(password, get_password());
+  EXPECT_EQ(ProxyConfigServiceTor::GetCircuitsCountForTesting(service.get()),
+            1u);
+
+  // ...and is cleared by the expiry timer exactly then, even without any
+  // further proxy resolution in the meantime.
+  FastForwardBy(base::TimeDelta::FromMinutes(1));
+  EXPECT_EQ(ProxyConfigServiceTor::GetCircuitsCountForTesting(service.get()),
+            0u);
+  const std::string new_password = get_password();
+  EXPECT_NE(password, new_password);
+
+  FastForwardBy(base::TimeDelta::FromMinutes(9));
+  EXPECT_EQ(new_password, get_password());
+}
+
 }  // namespace net